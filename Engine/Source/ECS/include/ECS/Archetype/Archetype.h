@@ -5,6 +5,7 @@
 #include "ECS/Entity.h"
 #include "ECS/Storage/SparseSet/SparseSet.h"
 #include "ECS/Component/Component.h"
+#include "ECS/Component/ComponentMask.h"
 #include "ECS/Component/ComponentSignature.h"
 
 namespace glaze::ecs {
@@ -23,6 +24,18 @@ namespace glaze::ecs {
 		ArchetypeId add;
 		ArchetypeId remove;
 		ArchetypeId take;
+
+		//column in the destination table for every column of the source table, Table::NO_COLUMN if it's dropped
+		//empty if both archetypes share a table
+		std::vector<size_t> add_columns;
+		std::vector<size_t> remove_columns;
+	};
+
+	//archetype an entity ends up in after adding or removing a bundle
+	struct ArchetypeTransition {
+		ArchetypeId archetype_id;
+		TableId table_id;
+		std::span<const size_t> columns;
 	};
 
 	struct Archetype {
@@ -36,6 +49,7 @@ namespace glaze::ecs {
 
 			for (const auto [i, c_id] : component_signature.table | std::views::enumerate) {
 				m_components.insert(c_id, StorageType::Table);
+				m_mask.set(c_id);
 				component_index[c_id][id] = ArchetypeRecord {
 					.column = static_cast<size_t>(i)
 				};
@@ -43,6 +57,7 @@ namespace glaze::ecs {
 
 			for (const ComponentId c_id : component_signature.sparse) {
 				m_components.insert(c_id, StorageType::SparseSet);
+				m_mask.set(c_id);
 				component_index[c_id][id] = ArchetypeRecord{
 					//TODO: handle -1 case
 					.column = -1u
@@ -78,6 +93,20 @@ namespace glaze::ecs {
 			return { is_last ? std::nullopt : std::make_optional(m_entities[index].entity), table_row };
 		}
 
+		void reserve(const size_t additional) {
+			m_entities.reserve(m_entities.size() + additional);
+		}
+
+		//removes the sorted unique rows in one pass, on_moved(entity, row) is called for every entity moved into a hole
+		template<typename F>
+		void remove_entities(const std::span<const size_t> sorted_rows, F&& on_moved) {
+			const auto moves = utils::swap_remove_moves(sorted_rows, m_entities.size());
+			utils::swap_remove_many(m_entities, sorted_rows, moves);
+			for (const auto [from, to] : moves) {
+				on_moved(m_entities[to].entity, ArchetypeRow::from_index(to));
+			}
+		}
+
 		[[nodiscard]] TableRow entity_table_row(const ArchetypeRow row) const noexcept {
 			return m_entities[row.to_index()].table_row;
 		}
@@ -108,6 +137,15 @@ namespace glaze::ecs {
 
 		[[nodiscard]] auto& edges(this auto& self) noexcept { return self.m_edges; }
 
+		//edge for the bundle, inserted empty if it doesn't exist yet
+		[[nodiscard]] ArchetypeEdge& edge(const BundleId bundle_id) {
+			if (const auto edge = m_edges.at(bundle_id)) {
+				return edge->get();
+			}
+			return m_edges.emplace(bundle_id);
+		}
+		[[nodiscard]] const ComponentMask& mask() const noexcept { return m_mask; }
+
 		[[nodiscard]] ArchetypeId id() const noexcept { return m_id; }
 		[[nodiscard]] TableId table_id() const noexcept { return m_table_id; }
 
@@ -118,6 +156,8 @@ namespace glaze::ecs {
 		[[nodiscard]] bool has_component(const ComponentId component_id) const noexcept { return m_components.contains(component_id); }
 
 		void clear_entities() noexcept { m_entities.clear(); }
+		//entities of an archetype with the same components, the cached edges are kept
+		void copy_entities_from(const Archetype& other) { m_entities = other.m_entities; }
 
 	private:
 		ArchetypeId m_id;
@@ -127,5 +167,6 @@ namespace glaze::ecs {
 
 		SparseArray<BundleId, ArchetypeEdge> m_edges;
 		SparseSet<ComponentId, StorageType> m_components;
+		ComponentMask m_mask;
 	};
 }
\ No newline at end of file
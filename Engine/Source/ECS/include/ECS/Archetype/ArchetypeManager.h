@@ -16,7 +16,8 @@ namespace glaze::ecs {
 		ArchetypeManager(ArchetypeManager&& other) = delete;
 		ArchetypeManager& operator=(ArchetypeManager&& other) = delete;
 
-		[[nodiscard]] std::pair<ArchetypeId, TableId> add_bundle_to_archetype(
+		//the column map of the table move is cached in the source archetype's edge together with the destination
+		[[nodiscard]] ArchetypeTransition add_bundle_to_archetype(
 			const ArchetypeId source_archetype_id,
 			const BundleId bundle_id,
 			const BundleManager& bundle_manager,
@@ -24,13 +25,12 @@ namespace glaze::ecs {
 			TableManager& table_manager
 		) {
 			auto& archetype = m_archetypes[source_archetype_id.to_index()];
-			auto& edges = archetype.edges();
 
 			//return early if we have cached edge
-			if (const auto edge = edges.at(bundle_id)) {
-				const auto add_edge = edge.value().get().add;
-				if (add_edge.valid()) {
-					return { add_edge, m_archetypes[add_edge.to_index()].table_id() };
+			if (const auto edge = archetype.edges().at(bundle_id)) {
+				const auto& cached = edge.value().get();
+				if (cached.add.valid()) {
+					return { cached.add, m_archetypes[cached.add.to_index()].table_id(), cached.add_columns };
 				}
 			}
 
@@ -42,25 +42,23 @@ namespace glaze::ecs {
 			std::vector<ComponentId> new_sparse_components;
 			new_sparse_components.reserve(bundle.sparse_components_count());
 
+			//components the archetype already has are replaced in place
 			for (const auto component_id : bundle.table_components()) {
-				if (archetype.has_component(component_id)) {
-					//TODO: component exists, we should update/replace or remove
-				} else {
+				if (!archetype.has_component(component_id)) {
 					new_table_components.push_back(component_id);
 				}
 			}
 			for (const auto component_id : bundle.sparse_components()) {
-				if (archetype.has_component(component_id)) {
-					//TODO: component exists, we should update/replace or remove
-				} else {
+				if (!archetype.has_component(component_id)) {
 					new_sparse_components.push_back(component_id);
 				}
 			}
 
 			//no new components means no archetype change
 			if (new_table_components.empty() && new_sparse_components.empty()) {
-				edges.insert(bundle_id, ArchetypeEdge{.add = source_archetype_id});
-				return { source_archetype_id, archetype.table_id() };
+				auto& edge = archetype.edge(bundle_id);
+				edge.add = source_archetype_id;
+				return { source_archetype_id, archetype.table_id(), edge.add_columns };
 			}
 
 			//we've got some new components, combine them with old ones, sort and create a new archetype
@@ -69,21 +67,92 @@ namespace glaze::ecs {
 			std::ranges::sort(new_table_components);
 			std::ranges::sort(new_sparse_components);
 
+			const auto source_table_id = archetype.table_id();
 			const auto table_id = table_manager.try_emplace(new_table_components, component_manager);
 			const auto new_archetype_id = try_emplace(table_id, new_table_components, new_sparse_components);
 
 			//a new archetype was created so existing archetype ref and edges ref are invalid now, get new ones and cache the edge
-			auto& valid_archetype = m_archetypes[source_archetype_id.to_index()];
-			auto& valid_edges = valid_archetype.edges();
-			valid_edges.insert(bundle_id, ArchetypeEdge{.add = new_archetype_id});
+			auto& edge = m_archetypes[source_archetype_id.to_index()].edge(bundle_id);
+			edge.add = new_archetype_id;
+			if (table_id != source_table_id) {
+				edge.add_columns = table_manager[source_table_id].column_map(table_manager[table_id]);
+			}
+
+			return { new_archetype_id, table_id, edge.add_columns };
+		}
+
+		//components of the bundle the archetype doesn't have are ignored
+		[[nodiscard]] ArchetypeTransition remove_bundle_from_archetype(
+			const ArchetypeId source_archetype_id,
+			const BundleId bundle_id,
+			const BundleManager& bundle_manager,
+			const ComponentManager& component_manager,
+			TableManager& table_manager
+		) {
+			auto& archetype = m_archetypes[source_archetype_id.to_index()];
+
+			if (const auto edge = archetype.edges().at(bundle_id)) {
+				const auto& cached = edge.value().get();
+				if (cached.remove.valid()) {
+					return { cached.remove, m_archetypes[cached.remove.to_index()].table_id(), cached.remove_columns };
+				}
+			}
+
+			const auto& bundle = bundle_manager[bundle_id];
+			const auto in_bundle = [&bundle](const ComponentId component_id) {
+				return std::ranges::contains(bundle.components(), component_id);
+			};
+
+			std::vector<ComponentId> new_table_components;
+			std::vector<ComponentId> new_sparse_components;
+			for (const auto component_id : archetype.table_components()) {
+				if (!in_bundle(component_id)) {
+					new_table_components.push_back(component_id);
+				}
+			}
+			for (const auto component_id : archetype.sparse_components()) {
+				if (!in_bundle(component_id)) {
+					new_sparse_components.push_back(component_id);
+				}
+			}
+
+			//nothing to remove means no archetype change
+			if (new_table_components.size() + new_sparse_components.size() == archetype.component_count()) {
+				auto& edge = archetype.edge(bundle_id);
+				edge.remove = source_archetype_id;
+				return { source_archetype_id, archetype.table_id(), edge.remove_columns };
+			}
 
-			return { new_archetype_id, table_id };
+			const auto source_table_id = archetype.table_id();
+			const auto table_id = table_manager.try_emplace(new_table_components, component_manager);
+			const auto new_archetype_id = try_emplace(table_id, new_table_components, new_sparse_components);
+
+			auto& edge = m_archetypes[source_archetype_id.to_index()].edge(bundle_id);
+			edge.remove = new_archetype_id;
+			if (table_id != source_table_id) {
+				edge.remove_columns = table_manager[source_table_id].column_map(table_manager[table_id]);
+			}
+
+			return { new_archetype_id, table_id, edge.remove_columns };
+		}
+
+		//archetype with exactly the sorted components, created together with its table if it doesn't exist yet
+		[[nodiscard]] ArchetypeId try_emplace(
+			const std::span<const ComponentId> table_components,
+			const std::span<const ComponentId> sparse_components,
+			const ComponentManager& component_manager,
+			TableManager& table_manager
+		) {
+			const auto table_id = table_manager.try_emplace(table_components, component_manager);
+			return try_emplace(table_id, table_components, sparse_components);
 		}
 
 		[[nodiscard]] ArchetypeVersion version() const noexcept { return ArchetypeVersion::from_index(m_archetypes.size()); }
 
 		[[nodiscard]] const ComponentIndex& component_index() const noexcept { return m_component_index; }
 		[[nodiscard]] std::span<const Archetype> archetypes() const noexcept { return m_archetypes; }
+		//masks of all archetypes indexed by archetype id, kept contiguous so matching can scan them without touching archetypes
+		[[nodiscard]] std::span<const ComponentMask> masks() const noexcept { return m_masks; }
 
 		[[nodiscard]] auto& empty_archetype(this auto& self) noexcept { return self.m_archetypes[EMPTY_ARCHETYPE_ID.to_index()]; }
 
@@ -120,11 +189,13 @@ namespace glaze::ecs {
 
 			const auto archetype_id = ArchetypeId::from_index(m_archetypes.size());
 			m_by_components.emplace(archetype_key, archetype_id);
-			m_archetypes.emplace_back(archetype_id, table_id, m_component_index, archetype_key);
+			const auto& archetype = m_archetypes.emplace_back(archetype_id, table_id, m_component_index, archetype_key);
+			m_masks.push_back(archetype.mask());
 			return archetype_id;
 		}
 
 		std::vector<Archetype> m_archetypes;
+		std::vector<ComponentMask> m_masks;
 		ByComponentsMap<ArchetypeId> m_by_components;
 		ComponentIndex m_component_index;
 	};
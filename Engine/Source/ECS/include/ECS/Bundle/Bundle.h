@@ -62,6 +62,19 @@ namespace glaze::ecs {
 	template<Component... Cs>
 	ComponentBundle(Cs&&...) -> ComponentBundle<Cs&&...>;
 
+	//owns its components unlike ComponentBundle, for bundles that outlive the expression creating them
+	template<Component... Cs>
+	struct OwnedBundle {
+		static_assert(((!std::is_reference_v<Cs> && !std::is_const_v<Cs>) && ...));
+
+		std::tuple<Cs...> m_components;
+
+		constexpr auto components() && noexcept {
+			return std::apply([](Cs&... cs) { return std::forward_as_tuple(std::move(cs)...); }, m_components);
+		}
+		constexpr auto components() & = delete;
+	};
+
 	template<Bundle B> requires (!std::is_lvalue_reference_v<B>)
 	constexpr void visit_bundle(B&& bundle, auto&& func) {
 		std::apply([&]<Component... Cs>(Cs&&... components) {
@@ -35,6 +35,24 @@ namespace glaze::ecs {
 			return bundle_id;
 		}
 
+		//bundle of the components in the given order, for components without a type of their own like pairs
+		BundleId register_bundle(const std::span<const ComponentId> component_ids, const ComponentManager& component_manager, Storage& storage) {
+			const auto it = m_dynamic_bundle_map.find(component_ids);
+			if (it != m_dynamic_bundle_map.end()) {
+				return it->second;
+			}
+
+			const auto bundle_id = BundleId::from_index(m_bundles.size());
+			m_bundles.push_back(BundleMeta::create(bundle_id, component_manager, component_ids));
+			m_dynamic_bundle_map.emplace(std::vector(component_ids.begin(), component_ids.end()), bundle_id);
+
+			for (const auto component_id : component_ids) {
+				storage.ensure_component(component_manager[component_id]);
+			}
+
+			return bundle_id;
+		}
+
 		[[nodiscard]] std::span<const BundleMeta> bundles() const noexcept { return m_bundles; }
 
 		template<Bundle B>
@@ -78,5 +96,6 @@ namespace glaze::ecs {
 	private:
 		std::vector<BundleMeta> m_bundles;
 		utils::TypeInfoMap<BundleId> m_bundle_map;
+		std::unordered_map<std::vector<ComponentId>, BundleId, ComponentIdHasher, ComponentIdEqual> m_dynamic_bundle_map;
 	};
 }
\ No newline at end of file
@@ -24,6 +24,22 @@ namespace glaze::ecs {
 			return BundleMeta{id, std::move(components)};
 		}
 
+		//bundle of registered components only known at runtime, e.g. pairs
+		[[nodiscard]] static BundleMeta create(const BundleId id, const ComponentManager& component_manager, const std::span<const ComponentId> component_ids) {
+			SparseSet<ComponentId, BundleComponent> components;
+			components.reserve(component_ids.size());
+
+			for (const auto component_id : component_ids) {
+				const auto& meta = component_manager[component_id];
+				if (components.contains(component_id)) {
+					utils::panic("Bundle {} has duplicate components {}", id.get(), meta.name());
+				}
+				components.emplace(component_id, meta.storage_type(), meta.name());
+			}
+
+			return BundleMeta{id, std::move(components)};
+		}
+
 		BundleMeta(const BundleMeta& other) = delete;
 		BundleMeta& operator=(const BundleMeta& other) = delete;
 
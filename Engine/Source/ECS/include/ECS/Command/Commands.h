@@ -0,0 +1,323 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <ranges>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "ECS/World.h"
+
+/*
+	Deferred structural changes.
+
+	Spawning, despawning, adding and removing components moves entities between tables, so it can't happen while a query iterates them.
+	Commands records the changes into a compact byte stream instead and applies them to the world at a sync point.
+
+	Consecutive commands of the same kind and bundle are applied as one batch:
+	spawns resolve the archetype once, despawns compact every table once
+	and additions and removals are ordered by the archetype the entity is in, so each cached archetype edge is walked for all its entities in a row.
+
+	A Commands buffer isn't thread safe, ParallelCommands gives every thread of a pool its own one.
+ */
+namespace glaze::ecs {
+	struct Commands {
+		Commands() = default;
+		~Commands() { clear(); }
+
+		Commands(const Commands& other) = delete;
+		Commands& operator=(const Commands& other) = delete;
+
+		Commands(Commands&& other) noexcept
+			: m_blocks(std::exchange(other.m_blocks, {})),
+			  m_current(std::exchange(other.m_current, 0)),
+			  m_size(std::exchange(other.m_size, 0)) {
+		}
+
+		Commands& operator=(Commands&& other) noexcept {
+			if (this != &other) {
+				clear();
+				m_blocks  = std::exchange(other.m_blocks, {});
+				m_current = std::exchange(other.m_current, 0);
+				m_size    = std::exchange(other.m_size, 0);
+			}
+			return *this;
+		}
+
+		//the bundle is moved into the buffer, so it has to own its components
+		template<Bundle B>
+		void spawn(B&& bundle) {
+			push<SpawnCommand<std::remove_cvref_t<B>>>(std::forward<B>(bundle));
+		}
+
+		template<Component ... Cs> requires (sizeof ... (Cs) > 0)
+		void spawn(Cs&& ... cs) {
+			spawn(OwnedBundle<std::remove_cvref_t<Cs>...>{ { std::forward<Cs>(cs)... } });
+		}
+
+		void despawn(const Entity entity) {
+			push<DespawnCommand>(entity);
+		}
+
+		//entities that don't exist anymore when the buffer is applied are skipped
+		template<Bundle B>
+		void add_bundle(const Entity entity, B&& bundle) {
+			push<AddCommand<std::remove_cvref_t<B>>>(entity, std::forward<B>(bundle));
+		}
+
+		template<Component ... Cs> requires (sizeof ... (Cs) > 0)
+		void add_components(const Entity entity, Cs&& ... cs) {
+			add_bundle(entity, OwnedBundle<std::remove_cvref_t<Cs>...>{ { std::forward<Cs>(cs)... } });
+		}
+
+		template<Bundle B>
+		void remove_bundle(const Entity entity) {
+			push<RemoveCommand<BundleKeyType<B>>>(entity);
+		}
+
+		template<Component ... Cs> requires (sizeof ... (Cs) > 0)
+		void remove_components(const Entity entity) {
+			remove_bundle<OwnedBundle<std::remove_cvref_t<Cs>...>>(entity);
+		}
+
+		//func(world) runs when the buffer is applied
+		template<std::invocable<World&> F>
+		void push_fn(F&& func) {
+			push<FnCommand<std::decay_t<F>>>(std::forward<F>(func));
+		}
+
+		//applies and empties the buffer, commands run in the order they were recorded
+		//commands recorded into this buffer while it's applied run after the ones that were already in it
+		void apply(World& world) {
+			do {
+				//commands may target entities reserved while recording
+				world.flush_entities();
+
+				//the records are applied from their own blocks, so recording into the buffer meanwhile can't move them
+				auto blocks = std::exchange(m_blocks, {});
+				m_current = 0;
+				m_size = 0;
+
+				std::vector<void*> run;
+				const CommandVTable* run_vtable = nullptr;
+
+				for_each_record(blocks, [&](const CommandVTable* const vtable, void* const command) {
+					if (vtable != run_vtable && !run.empty()) {
+						run_vtable->apply(world, run);
+						run.clear();
+					}
+					run_vtable = vtable;
+					run.push_back(command);
+				});
+
+				if (!run.empty()) {
+					run_vtable->apply(world, run);
+				}
+
+				//the applied blocks are kept for reuse behind the ones recorded meanwhile
+				for (auto& block : blocks) {
+					block.used = 0;
+				}
+				m_blocks.insert(m_blocks.end(), std::make_move_iterator(blocks.begin()), std::make_move_iterator(blocks.end()));
+			} while (!empty());
+		}
+
+		//drops all the commands without applying them
+		void clear() noexcept {
+			for_each_record(m_blocks, [](const CommandVTable* const vtable, void* const command) {
+				vtable->drop(command);
+			});
+			reset();
+		}
+
+		[[nodiscard]] size_t size() const noexcept { return m_size; }
+		[[nodiscard]] bool empty() const noexcept { return m_size == 0; }
+
+	private:
+		struct CommandVTable {
+			//applies and destroys a run of commands of the same type
+			void(*apply)(World& world, std::span<void* const> commands);
+			void(*drop)(void* command) noexcept;
+		};
+
+		struct RecordHeader {
+			const CommandVTable* vtable;
+			size_t size;
+		};
+
+		struct Block {
+			std::unique_ptr<std::byte[]> data;
+			size_t capacity = 0;
+			size_t used = 0;
+		};
+
+		static constexpr size_t ALIGNMENT = alignof(std::max_align_t);
+		static constexpr size_t BLOCK_SIZE = 16 * 1024;
+
+		static constexpr size_t HEADER_SIZE = (sizeof(RecordHeader) + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+
+		[[nodiscard]] static constexpr size_t align_up(const size_t size) noexcept {
+			return (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+		}
+
+		template<Bundle B>
+		struct SpawnCommand {
+			B bundle;
+
+			static void apply(World& world, auto&& commands) {
+				world.spawn_batch(commands | std::views::transform([](SpawnCommand* const command) -> B&& { return std::move(command->bundle); }));
+			}
+		};
+
+		struct DespawnCommand {
+			Entity entity;
+
+			static void apply(World& world, auto&& commands) {
+				std::vector<Entity> entities;
+				entities.reserve(std::ranges::size(commands));
+				for (const DespawnCommand* const command : commands) {
+					entities.push_back(command->entity);
+				}
+				world.destroy_entities(entities);
+			}
+		};
+
+		template<Bundle B>
+		struct AddCommand {
+			Entity entity;
+			B bundle;
+
+			static void apply(World& world, auto&& commands) {
+				for (AddCommand* const command : by_archetype<AddCommand>(world, commands)) {
+					if (world.entity_manager().is_valid(command->entity)) {
+						world.add_bundle(command->entity, std::move(command->bundle));
+					}
+				}
+			}
+		};
+
+		template<typename Key>
+		struct RemoveCommand {
+			Entity entity;
+
+			static void apply(World& world, auto&& commands) {
+				for (const RemoveCommand* const command : by_archetype<RemoveCommand>(world, commands)) {
+					world.remove_bundle<OwnedBundleOf<Key>>(command->entity);
+				}
+			}
+		};
+
+		template<typename F>
+		struct FnCommand {
+			F func;
+
+			static void apply(World& world, auto&& commands) {
+				for (FnCommand* const command : commands) {
+					command->func(world);
+				}
+			}
+		};
+
+		template<typename Tuple>
+		struct OwnedBundleFor;
+
+		template<Component ... Cs>
+		struct OwnedBundleFor<std::tuple<Cs...>> {
+			using type = OwnedBundle<Cs...>;
+		};
+
+		template<typename Key>
+		using OwnedBundleOf = OwnedBundleFor<Key>::type;
+
+		//stable order by the entity's archetype, so entities of one archetype take the same edge one after another
+		//and commands for the same entity keep their order
+		template<typename C>
+		[[nodiscard]] static std::vector<C*> by_archetype(const World& world, auto&& commands) {
+			std::vector<std::pair<uint32_t, C*>> keyed;
+			keyed.reserve(std::ranges::size(commands));
+			for (C* const command : commands) {
+				const auto location = world.entity_manager().get_location(command->entity);
+				keyed.emplace_back(location ? location->archetype_id.get() : std::numeric_limits<uint32_t>::max(), command);
+			}
+			std::ranges::stable_sort(keyed, {}, [](const auto& p) { return p.first; });
+
+			std::vector<C*> sorted;
+			sorted.reserve(keyed.size());
+			for (const auto& [key, command] : keyed) {
+				sorted.push_back(command);
+			}
+			return sorted;
+		}
+
+		template<typename C>
+		static constexpr CommandVTable VTABLE{
+			[](World& world, const std::span<void* const> commands) {
+				C::apply(world, commands | std::views::transform([](void* const command) { return static_cast<C*>(command); }));
+				for (void* const command : commands) {
+					std::destroy_at(static_cast<C*>(command));
+				}
+			},
+			[](void* const command) noexcept {
+				std::destroy_at(static_cast<C*>(command));
+			}
+		};
+
+		template<typename C, typename ... Args>
+		void push(Args&& ... args) {
+			static_assert(alignof(C) <= ALIGNMENT, "Over aligned commands aren't supported");
+			constexpr size_t size = align_up(sizeof(C));
+
+			std::byte* const record = allocate(HEADER_SIZE + size);
+			::new (record) RecordHeader{ &VTABLE<C>, size };
+			::new (record + HEADER_SIZE) C{ std::forward<Args>(args)... };
+			++m_size;
+		}
+
+		[[nodiscard]] std::byte* allocate(const size_t bytes) {
+			for (; m_current < m_blocks.size(); ++m_current) {
+				auto& block = m_blocks[m_current];
+				if (block.capacity - block.used >= bytes) {
+					std::byte* const ptr = block.data.get() + block.used;
+					block.used += bytes;
+					return ptr;
+				}
+			}
+
+			const size_t capacity = std::max(BLOCK_SIZE, bytes);
+			m_blocks.push_back(Block{ std::make_unique_for_overwrite<std::byte[]>(capacity), capacity, bytes });
+			m_current = m_blocks.size() - 1;
+			return m_blocks.back().data.get();
+		}
+
+		template<typename F>
+		static void for_each_record(std::vector<Block>& blocks, F&& func) {
+			for (auto& block : blocks) {
+				for (size_t offset = 0; offset < block.used;) {
+					std::byte* const record = block.data.get() + offset;
+					const auto* const header = std::launder(reinterpret_cast<RecordHeader*>(record));
+					func(header->vtable, static_cast<void*>(record + HEADER_SIZE));
+					offset += HEADER_SIZE + header->size;
+				}
+			}
+		}
+
+		//keeps the blocks for the next frame
+		void reset() noexcept {
+			for (auto& block : m_blocks) {
+				block.used = 0;
+			}
+			m_current = 0;
+			m_size = 0;
+		}
+
+		std::vector<Block> m_blocks;
+		size_t m_current = 0;
+		size_t m_size = 0;
+	};
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "Utils/ThreadPool.h"
+
+#include "Commands.h"
+
+namespace glaze::ecs {
+	//one command buffer per thread of a pool, so systems can record structural changes from parallel iteration without locking
+	struct ParallelCommands {
+		explicit ParallelCommands(const utils::ThreadPool& pool)
+			: m_pool(&pool), m_commands(pool.concurrency()) {
+		}
+
+		//buffer of the calling thread, only valid to use on that thread
+		[[nodiscard]] Commands& local() noexcept {
+			return m_commands[m_pool->current_thread_index()];
+		}
+
+		//applies the buffers one after another in thread index order, must not overlap with recording
+		void apply(World& world) {
+			for (auto& commands : m_commands) {
+				commands.apply(world);
+			}
+		}
+
+		void clear() noexcept {
+			for (auto& commands : m_commands) {
+				commands.clear();
+			}
+		}
+
+		[[nodiscard]] size_t size() const noexcept {
+			size_t size = 0;
+			for (const auto& commands : m_commands) {
+				size += commands.size();
+			}
+			return size;
+		}
+
+		[[nodiscard]] bool empty() const noexcept { return size() == 0; }
+
+	private:
+		const utils::ThreadPool* m_pool;
+		std::vector<Commands> m_commands;
+	};
+}
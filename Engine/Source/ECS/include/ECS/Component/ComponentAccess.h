@@ -0,0 +1,62 @@
+#pragma once
+
+#include <algorithm>
+#include <span>
+#include <vector>
+
+#include "ECS/Ids.h"
+
+namespace glaze::ecs {
+	//components read and written by a system, two systems can run at the same time if neither writes what the other one touches
+	//ids are kept sorted, so checking a pair of systems is a linear merge
+	struct ComponentAccess {
+		void add_read(const ComponentId id) { insert(m_reads, id); }
+		void add_write(const ComponentId id) { insert(m_writes, id); }
+
+		//conflicts with every other access, for systems that change the world structure
+		void set_exclusive() noexcept { m_exclusive = true; }
+
+		void extend(const ComponentAccess& other) {
+			for (const auto id : other.m_reads) {
+				add_read(id);
+			}
+			for (const auto id : other.m_writes) {
+				add_write(id);
+			}
+			m_exclusive |= other.m_exclusive;
+		}
+
+		[[nodiscard]] bool is_compatible(const ComponentAccess& other) const noexcept {
+			if (m_exclusive || other.m_exclusive) {
+				return false;
+			}
+			return !intersects(m_writes, other.m_writes) && !intersects(m_writes, other.m_reads) && !intersects(m_reads, other.m_writes);
+		}
+
+		[[nodiscard]] std::span<const ComponentId> reads() const noexcept { return m_reads; }
+		[[nodiscard]] std::span<const ComponentId> writes() const noexcept { return m_writes; }
+		[[nodiscard]] bool is_exclusive() const noexcept { return m_exclusive; }
+
+	private:
+		static void insert(std::vector<ComponentId>& ids, const ComponentId id) {
+			const auto it = std::ranges::lower_bound(ids, id);
+			if (it == ids.end() || *it != id) {
+				ids.insert(it, id);
+			}
+		}
+
+		[[nodiscard]] static bool intersects(const std::span<const ComponentId> a, const std::span<const ComponentId> b) noexcept {
+			for (size_t i = 0, j = 0; i < a.size() && j < b.size();) {
+				if (a[i] == b[j]) {
+					return true;
+				}
+				a[i] < b[j] ? ++i : ++j;
+			}
+			return false;
+		}
+
+		std::vector<ComponentId> m_reads;
+		std::vector<ComponentId> m_writes;
+		bool m_exclusive = false;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include "ECS/Component/Component.h"
+#include "ECS/Entity.h"
+
+/*
+	Hooks invoked when components are added to, replaced on or removed from entities.
+
+	Hooks are registered per component id and invoked with batches: the entities of a batch are contiguous rows of a table
+	and their values are contiguous in the component's column or sparse set, so a hook sees the values where they're stored.
+	Spawning many entities at once or destroying them at once invokes a hook once per run of rows instead of once per entity.
+
+	Add hooks run after the values were written, replace hooks after the new values were written
+	and remove hooks before the values are destroyed.
+	Hooks must not change the world's structure. Restoring snapshots and clones doesn't invoke hooks.
+	Applying a delta invokes the remove hooks of the entities it destroys, and of the ChildOf components and pairs
+	that destroying them removes from other entities. The entities it spawns or moves are placed without hooks.
+ */
+namespace glaze::ecs {
+	enum class ComponentHook : uint8_t {
+		Add,
+		Replace,
+		Remove
+	};
+
+	//values[i] is the component of entities[i], values is null for zero sized components
+	struct ComponentHookBatch {
+		ComponentId component_id;
+		std::span<const Entity> entities;
+		const void* values;
+	};
+
+	struct ComponentHooks {
+		//func is invoked with (std::span<const Entity>, std::span<const T>), the span of values is empty for zero sized components
+		template<Component T, typename F> requires std::invocable<F&, std::span<const Entity>, std::span<const std::remove_cvref_t<T>>>
+		void add(const ComponentId component_id, const ComponentHook hook, F&& func) {
+			using State = HookState<std::remove_cvref_t<T>, std::decay_t<F>>;
+			auto state = new State{ std::forward<F>(func) };
+
+			if (component_id.to_index() >= m_hooks.size()) {
+				m_hooks.resize(component_id.to_index() + 1);
+			}
+			m_hooks[component_id.to_index()][static_cast<size_t>(hook)].push_back(Hook{ std::unique_ptr<void, DestroyFn>(state, &State::destroy), &State::invoke });
+			++m_count;
+		}
+
+		[[nodiscard]] bool contains(const ComponentId component_id, const ComponentHook hook) const noexcept {
+			return component_id.to_index() < m_hooks.size() && !m_hooks[component_id.to_index()][static_cast<size_t>(hook)].empty();
+		}
+
+		void invoke(const ComponentHook hook, const ComponentHookBatch& batch) const {
+			for (const auto& h : m_hooks[batch.component_id.to_index()][static_cast<size_t>(hook)]) {
+				h.invoke(h.state.get(), batch);
+			}
+		}
+
+		//drops the hooks of the component
+		void remove(const ComponentId component_id) noexcept {
+			if (component_id.to_index() >= m_hooks.size()) {
+				return;
+			}
+			for (auto& hooks : m_hooks[component_id.to_index()]) {
+				m_count -= hooks.size();
+				hooks.clear();
+			}
+		}
+
+		void clear() noexcept {
+			m_hooks.clear();
+			m_count = 0;
+		}
+
+		[[nodiscard]] size_t size() const noexcept { return m_count; }
+		[[nodiscard]] bool empty() const noexcept { return m_count == 0; }
+
+	private:
+		template<typename T, typename F>
+		struct HookState {
+			F func;
+
+			static void invoke(void* const ptr, const ComponentHookBatch& batch) {
+				auto& state = *static_cast<HookState*>(ptr);
+				if constexpr (std::is_empty_v<T>) {
+					state.func(batch.entities, std::span<const T>{});
+				} else {
+					state.func(batch.entities, std::span(static_cast<const T*>(batch.values), batch.entities.size()));
+				}
+			}
+
+			static void destroy(void* const ptr) noexcept {
+				delete static_cast<HookState*>(ptr);
+			}
+		};
+
+		using InvokeFn = void(*)(void* state, const ComponentHookBatch& batch);
+		using DestroyFn = void(*)(void* state) noexcept;
+
+		struct Hook {
+			std::unique_ptr<void, DestroyFn> state;
+			InvokeFn invoke;
+		};
+
+		//hooks of every component, indexed by component id and hook
+		std::vector<std::array<std::vector<Hook>, 3>> m_hooks;
+		size_t m_count = 0;
+	};
+}
\ No newline at end of file
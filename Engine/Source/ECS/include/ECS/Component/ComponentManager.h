@@ -1,6 +1,13 @@
 #pragma once
 
+#include <cassert>
 #include <ranges>
+#include <span>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Utils/HashCombine.h"
 
 #include "ComponentMeta.h"
 
@@ -16,19 +23,130 @@ namespace glaze::ecs {
 
 		template<Component T>
 		ComponentId register_component() {
-			constexpr auto type_id = utils::TypeInfo::of<std::remove_cvref_t<T>>();
-			const auto indices_it = m_components_map.find(type_id);
+			return register_component(ComponentDesc::of<T>());
+		}
+
+		//registers the type the description was made of, e.g. a component of another world
+		ComponentId register_component(const ComponentDesc& desc) {
+			const auto indices_it = m_components_map.find(desc.type_info());
 			if (indices_it != m_components_map.end()) {
 				return indices_it->second;
 			}
 
 			const auto id = ComponentId::from_index(m_components.size());
-			m_components.emplace_back(id, ComponentDesc::of<T>());
-			m_components_map.emplace(type_id, id);
+			m_components.emplace_back(id, desc);
+			m_components_map.emplace(desc.type_info(), id);
 
 			return id;
 		}
 
+		//id of the (relation, target) pair, registered on first use
+		//a pair is a component of its own with the relation's layout and storage, entities with different targets live in different archetypes
+		//ids of released pairs of the relation are reused first
+		ComponentId register_pair(const ComponentId relation, const Entity target) {
+			assert(is_id_valid(relation) && !m_components[relation.to_index()].is_pair() && "A pair's relation has to be a registered component");
+			const auto [it, inserted] = m_pairs.try_emplace(PairKey{ relation, target.to_id() });
+			if (!inserted) {
+				return it->second;
+			}
+
+			ComponentId id;
+			if (auto& free = m_free_pairs[relation]; !free.empty()) {
+				id = free.back();
+				free.pop_back();
+				m_components[id.to_index()].m_target = target;
+			} else {
+				id = ComponentId::from_index(m_components.size());
+				const ComponentDesc relation_desc = m_components[relation.to_index()].m_desc;
+				m_components.emplace_back(id, relation_desc, relation, target);
+			}
+			it->second = id;
+			m_relation_pairs[relation].push_back(id);
+			m_target_pairs[target.to_id()].push_back(id);
+
+			return id;
+		}
+
+		//unregisters the pairs targeting a destroyed entity, no entity may have them anymore
+		//a released pair keeps its id and relation without a target until register_pair reuses it for the same relation,
+		//so the archetypes, tables and sparse sets made for it stay valid
+		void release_pairs(const Entity target) {
+			const auto it = m_target_pairs.find(target.to_id());
+			if (it == m_target_pairs.end()) {
+				return;
+			}
+
+			for (const auto id : it->second) {
+				auto& meta = m_components[id.to_index()];
+				m_pairs.erase(PairKey{ meta.m_relation, target.to_id() });
+				std::erase(m_relation_pairs[meta.m_relation], id);
+				m_free_pairs[meta.m_relation].push_back(id);
+				meta.m_target = Entity{};
+			}
+			m_target_pairs.erase(it);
+		}
+
+		//gives the pair with the id of another manager's pair the same relation and target, see World::clone_into
+		//null if this manager has another component with that id, copy_pairs_from has to follow once every pair is copied
+		ComponentId copy_pair(const ComponentMeta& pair) {
+			const auto index = pair.id().to_index();
+			if (index == m_components.size()) {
+				m_components.emplace_back(pair.id(), pair.m_desc, pair.m_relation, pair.m_target);
+			} else if (index > m_components.size() || m_components[index].m_relation != pair.m_relation) {
+				return utils::null_id;
+			}
+			m_components[index].m_target = pair.m_target;
+			return pair.id();
+		}
+
+		//takes over the pair lookups and released pairs of other, pairs only this manager has are released
+		void copy_pairs_from(const ComponentManager& other) {
+			m_pairs = other.m_pairs;
+			m_relation_pairs = other.m_relation_pairs;
+			m_target_pairs = other.m_target_pairs;
+			m_free_pairs = other.m_free_pairs;
+			for (auto& meta : m_components | std::views::drop(other.size())) {
+				if (meta.is_pair()) {
+					meta.m_target = Entity{};
+					m_free_pairs[meta.m_relation].push_back(meta.id());
+				}
+			}
+		}
+
+		template<Component R>
+		ComponentId register_pair(const Entity target) {
+			return register_pair(register_component<R>(), target);
+		}
+
+		//null if the pair isn't registered
+		[[nodiscard]] ComponentId pair_id(const ComponentId relation, const Entity target) const noexcept {
+			const auto it = m_pairs.find(PairKey{ relation, target.to_id() });
+			if (it == m_pairs.end()) {
+				return utils::null_id;
+			}
+			return it->second;
+		}
+
+		//(relation, *): pairs of the relation with any target
+		[[nodiscard]] std::span<const ComponentId> relation_pairs(const ComponentId relation) const noexcept {
+			const auto it = m_relation_pairs.find(relation);
+			if (it == m_relation_pairs.end()) {
+				return {};
+			}
+			return it->second;
+		}
+
+		//(*, target): pairs of any relation with the target
+		[[nodiscard]] std::span<const ComponentId> target_pairs(const Entity target) const noexcept {
+			const auto it = m_target_pairs.find(target.to_id());
+			if (it == m_target_pairs.end()) {
+				return {};
+			}
+			return it->second;
+		}
+
+		[[nodiscard]] bool has_pairs() const noexcept { return !m_pairs.empty(); }
+
 		template<Component T>
 		[[nodiscard]] ComponentId component_id() const noexcept {
 			return component_id(utils::TypeInfo::of<std::remove_cvref_t<T>>());
@@ -87,7 +205,22 @@ namespace glaze::ecs {
 		[[nodiscard]] bool empty() const noexcept { return m_components.empty(); }
 
 	private:
+		using PairKey = std::pair<ComponentId, EntityID>;
+
+		struct PairKeyHasher {
+			[[nodiscard]] size_t operator()(const PairKey& key) const noexcept {
+				size_t seed = 0;
+				utils::hash_combine(seed, key.first, key.second);
+				return seed;
+			}
+		};
+
 		std::vector<ComponentMeta> m_components;
 		utils::TypeInfoMap<ComponentId> m_components_map;
+		std::unordered_map<PairKey, ComponentId, PairKeyHasher> m_pairs;
+		std::unordered_map<ComponentId, std::vector<ComponentId>> m_relation_pairs;
+		std::unordered_map<EntityID, std::vector<ComponentId>> m_target_pairs;
+		//ids of released pairs by relation
+		std::unordered_map<ComponentId, std::vector<ComponentId>> m_free_pairs;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "ECS/Ids.h"
+
+namespace glaze::ecs {
+	//fixed width bitset of component ids, testing a whole signature costs a few word operations instead of one sparse lookup per component
+	//ids past CAPACITY aren't representable, callers have to fall back to exact lookups for them
+	struct ComponentMask {
+		static constexpr size_t WORD_BITS = 64;
+		static constexpr size_t WORD_COUNT = 4;
+		static constexpr size_t CAPACITY = WORD_COUNT * WORD_BITS;
+
+		[[nodiscard]] static constexpr bool fits(const ComponentId id) noexcept { return id.to_index() < CAPACITY; }
+
+		//returns false if the id doesn't fit into the mask
+		constexpr bool set(const ComponentId id) noexcept {
+			if (!fits(id)) {
+				return false;
+			}
+			const auto index = id.to_index();
+			m_words[index / WORD_BITS] |= uint64_t{1} << (index % WORD_BITS);
+			return true;
+		}
+
+		[[nodiscard]] constexpr bool test(const ComponentId id) const noexcept {
+			if (!fits(id)) {
+				return false;
+			}
+			const auto index = id.to_index();
+			return (m_words[index / WORD_BITS] >> (index % WORD_BITS)) & 1u;
+		}
+
+		//(this & other) == other
+		[[nodiscard]] constexpr bool contains_all(const ComponentMask& other) const noexcept {
+			uint64_t missing = 0;
+			for (size_t i = 0; i < WORD_COUNT; ++i) {
+				missing |= other.m_words[i] & ~m_words[i];
+			}
+			return missing == 0;
+		}
+
+		//(this & other) != 0
+		[[nodiscard]] constexpr bool intersects(const ComponentMask& other) const noexcept {
+			uint64_t common = 0;
+			for (size_t i = 0; i < WORD_COUNT; ++i) {
+				common |= other.m_words[i] & m_words[i];
+			}
+			return common != 0;
+		}
+
+		[[nodiscard]] constexpr bool none() const noexcept {
+			uint64_t any = 0;
+			for (const auto word : m_words) {
+				any |= word;
+			}
+			return any == 0;
+		}
+
+		[[nodiscard]] constexpr bool operator==(const ComponentMask&) const noexcept = default;
+
+	private:
+		std::array<uint64_t, WORD_COUNT> m_words{};
+	};
+}
\ No newline at end of file
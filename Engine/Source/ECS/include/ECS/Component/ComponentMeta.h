@@ -4,6 +4,7 @@
 #include "Utils/TypeOps.h"
 #include "Utils/TypeInfo.h"
 
+#include "ECS/Entity.h"
 #include "Component.h"
 
 namespace glaze::ecs {
@@ -48,6 +49,11 @@ namespace glaze::ecs {
 			: m_id(id), m_desc(desc) {
 		}
 
+		//(relation, target) pair, stored like the relation component
+		ComponentMeta(const ComponentId id, const ComponentDesc& relation_desc, const ComponentId relation, const Entity target) noexcept
+			: m_id(id), m_desc(relation_desc), m_relation(relation), m_target(target) {
+		}
+
 		ComponentMeta(const ComponentMeta& other) = delete;
 		ComponentMeta& operator=(const ComponentMeta& other) = delete;
 
@@ -61,10 +67,18 @@ namespace glaze::ecs {
 		[[nodiscard]] const utils::TypeInfo& type_info() const noexcept { return m_desc.m_type_info; }
 		[[nodiscard]] const utils::TypeOps& type_ops() const noexcept { return m_desc.m_type_ops; }
 
+		[[nodiscard]] bool is_pair() const noexcept { return m_relation.valid(); }
+		//relation component of a pair, null for other components
+		[[nodiscard]] ComponentId relation() const noexcept { return m_relation; }
+		//target entity of a pair, null once the pair was released, see ComponentManager::release_pairs
+		[[nodiscard]] Entity target() const noexcept { return m_target; }
+
 	private:
 		friend struct ComponentManager;
 
 		ComponentId m_id;
 		ComponentDesc m_desc;
+		ComponentId m_relation;
+		Entity m_target;
 	};
 }
\ No newline at end of file
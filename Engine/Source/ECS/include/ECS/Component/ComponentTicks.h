@@ -0,0 +1,120 @@
+#pragma once
+
+#include <atomic>
+#include <compare>
+#include <cstdint>
+
+/*
+	Change detection ticks.
+
+	The world tick grows with every query run and every component write is stamped with the current one.
+	Ticks wrap around, so they are only compared relative to the tick a query runs at:
+	a change is visible if it happened after the previous run of the same query.
+	World::check_change_ticks clamps ticks older than MAX_CHANGE_AGE before they get half the range behind the world tick,
+	so old ticks never wrap around and look new again.
+ */
+namespace glaze::ecs {
+	struct Tick {
+		//ticks further behind the world tick are clamped to this age
+		static constexpr uint32_t MAX_CHANGE_AGE = 1u << 30;
+		//the world tick may advance this far between two clamping passes, ages stay below half the range
+		static constexpr uint32_t CHECK_TICK_INTERVAL = 1u << 29;
+
+		constexpr Tick() noexcept = default;
+		constexpr explicit Tick(const uint32_t value) noexcept : m_value(value) {}
+
+		[[nodiscard]] constexpr uint32_t get() const noexcept { return m_value; }
+
+		//true if this tick is more recent than last_run, both seen from this_run
+		[[nodiscard]] constexpr bool is_newer_than(const Tick last_run, const Tick this_run) const noexcept {
+			return this_run.m_value - last_run.m_value > this_run.m_value - m_value;
+		}
+
+		//moves the tick up to MAX_CHANGE_AGE behind this_run if it's older
+		constexpr void clamp(const Tick this_run) noexcept {
+			if (this_run.m_value - m_value > MAX_CHANGE_AGE) {
+				m_value = this_run.m_value - MAX_CHANGE_AGE;
+			}
+		}
+
+		[[nodiscard]] constexpr auto operator<=>(const Tick&) const noexcept = default;
+
+	private:
+		uint32_t m_value = 0;
+	};
+
+	struct ComponentTicks {
+		Tick added;
+		Tick changed;
+
+		[[nodiscard]] constexpr bool is_added(const Tick last_run, const Tick this_run) const noexcept {
+			return added.is_newer_than(last_run, this_run);
+		}
+
+		[[nodiscard]] constexpr bool is_changed(const Tick last_run, const Tick this_run) const noexcept {
+			return changed.is_newer_than(last_run, this_run);
+		}
+
+		constexpr void clamp(const Tick this_run) noexcept {
+			added.clamp(this_run);
+			changed.clamp(this_run);
+		}
+	};
+
+	//newest tick written to a whole column, lets Added and Changed skip columns nobody wrote to since the last run
+	//rows of one column may be stamped from several threads, so the tick is a relaxed atomic raised with a compare exchange loop
+	struct TickWatermark {
+		TickWatermark() noexcept = default;
+		TickWatermark(const TickWatermark& other) noexcept : m_value(other.m_value.load(std::memory_order_relaxed)) {}
+
+		TickWatermark& operator=(const TickWatermark& other) noexcept {
+			m_value.store(other.m_value.load(std::memory_order_relaxed), std::memory_order_relaxed);
+			return *this;
+		}
+
+		//ticks closer than half the range apart are ordered by their wrapping difference, which clamping guarantees
+		void raise(const Tick tick) noexcept {
+			auto current = m_value.load(std::memory_order_relaxed);
+			while (static_cast<int32_t>(tick.get() - current) > 0
+				&& !m_value.compare_exchange_weak(current, tick.get(), std::memory_order_relaxed)) {
+			}
+		}
+
+		//only while no other thread raises the watermark
+		void clamp(const Tick this_run) noexcept {
+			auto tick = get();
+			tick.clamp(this_run);
+			m_value.store(tick.get(), std::memory_order_relaxed);
+		}
+
+		[[nodiscard]] Tick get() const noexcept { return Tick{ m_value.load(std::memory_order_relaxed) }; }
+
+	private:
+		std::atomic<uint32_t> m_value = 0;
+	};
+
+	//tick of a world, queries of systems running at the same time advance it concurrently
+	struct TickCounter {
+		constexpr explicit TickCounter(const Tick tick) noexcept : m_value(tick.get()) {}
+		TickCounter(const TickCounter& other) noexcept : m_value(other.m_value.load(std::memory_order_relaxed)) {}
+
+		TickCounter& operator=(const TickCounter& other) noexcept {
+			m_value.store(other.m_value.load(std::memory_order_relaxed), std::memory_order_relaxed);
+			return *this;
+		}
+
+		//returns the tick before the increment
+		Tick increment() noexcept { return Tick{ m_value.fetch_add(1, std::memory_order_relaxed) }; }
+
+		[[nodiscard]] Tick get() const noexcept { return Tick{ m_value.load(std::memory_order_relaxed) }; }
+
+	private:
+		std::atomic<uint32_t> m_value;
+	};
+
+	//ticks a query iterates with, changes newer than last_run are visible and writes are stamped with this_run
+	struct RunTicks {
+		Tick last_run;
+		Tick this_run;
+	};
+}
@@ -1,9 +1,11 @@
 #pragma once
 
+#include <atomic>
 #include <cassert>
 #include <cstdint>
 #include <format>
 #include <optional>
+#include <span>
 #include <vector>
 
 #include "Ids.h"
@@ -43,15 +45,23 @@ namespace glaze::ecs {
 		[[nodiscard]] constexpr EntityVersion version() const noexcept { return m_version; }
 
 		[[nodiscard]] constexpr auto operator<=>(const Entity& other) const noexcept { return to_id() <=> other.to_id(); }
+		[[nodiscard]] constexpr bool operator==(const Entity& other) const noexcept { return to_id() == other.to_id(); }
 
 	private:
 		EntityIndex m_index;
 		EntityVersion m_version;
 	};
 
+	/*
+		Entities are slots of a vector, destroyed slots are reused with a bumped version.
+
+		Ids can also be reserved from any number of threads at once, without a lock.
+		The free cursor counts the destroyed slots that haven't been handed out yet,
+		reserving takes slots from the back of the free list and continues past the end of the slots once it runs negative.
+		Reserved entities exist only after flush, which has to run before any other change to the manager.
+	 */
 	struct EntityManager {
 		struct Slot {
-			EntityIndex next = utils::null_id;
 			EntityVersion version = FIRST_ENTITY_VERSION;
 			EntityLocation location = NULL_ENTITY_LOCATION;
 		};
@@ -65,33 +75,94 @@ namespace glaze::ecs {
 		EntityManager& operator=(EntityManager&& other) = delete;
 
 		[[nodiscard]] Entity create_entity() {
-			if (m_destroyed == 0) {
-				const auto& [next, version, location] = m_slots.emplace_back(EntityIndex::from_index(m_slots.size()));
-				return Entity{next, version};
+			assert(!needs_flush() && "Reserved entities have to be flushed first");
+			if (m_free.empty()) {
+				const auto index = EntityIndex::from_index(m_slots.size());
+				const auto& [version, location] = m_slots.emplace_back();
+				return Entity{index, version};
+			}
+
+			const EntityIndex index = m_free.back();
+			m_free.pop_back();
+			m_free_cursor.store(static_cast<int64_t>(m_free.size()), std::memory_order_relaxed);
+			return Entity{index, m_slots[index.to_index()].version};
+		}
+
+		//safe to call from several threads at once, but not together with anything else modifying the manager
+		[[nodiscard]] Entity reserve_entity() noexcept {
+			const auto cursor = m_free_cursor.fetch_sub(1, std::memory_order_relaxed);
+			if (cursor > 0) {
+				const auto index = m_free[static_cast<size_t>(cursor - 1)];
+				return Entity{index, m_slots[index.to_index()].version};
+			}
+			return Entity{EntityIndex::from_index(m_slots.size() + static_cast<size_t>(-cursor))};
+		}
+
+		//fills entities with reserved ids using a single atomic operation, same rules as reserve_entity
+		void reserve_entities(const std::span<Entity> entities) noexcept {
+			const auto count = static_cast<int64_t>(entities.size());
+			const auto cursor = m_free_cursor.fetch_sub(count, std::memory_order_relaxed);
+
+			for (int64_t i = 0; i < count; ++i) {
+				const auto slot = cursor - 1 - i;
+				if (slot >= 0) {
+					const auto index = m_free[static_cast<size_t>(slot)];
+					entities[i] = Entity{index, m_slots[index.to_index()].version};
+				} else {
+					entities[i] = Entity{EntityIndex::from_index(m_slots.size() + static_cast<size_t>(-slot - 1))};
+				}
 			}
+		}
+
+		[[nodiscard]] bool needs_flush() const noexcept {
+			return m_free_cursor.load(std::memory_order_relaxed) != static_cast<int64_t>(m_free.size());
+		}
+
+		//makes the reserved entities real, init(entity) is called for each of them to give it a location
+		template<typename F>
+		void flush(F&& init) {
+			const auto cursor = m_free_cursor.load(std::memory_order_relaxed);
+			const size_t free_left = cursor > 0 ? static_cast<size_t>(cursor) : 0;
 
-			const EntityIndex index = m_head;
-			auto& [next, version, location] = m_slots[index.to_index()];
-			m_head = next;
-			m_destroyed--;
-			return Entity{index, version};
+			for (size_t i = m_free.size(); i > free_left; --i) {
+				const auto index = m_free[i - 1];
+				init(Entity{index, m_slots[index.to_index()].version});
+			}
+			m_free.resize(free_left);
+
+			if (cursor < 0) {
+				const auto first = m_slots.size();
+				m_slots.resize(first + static_cast<size_t>(-cursor));
+				for (size_t i = first; i < m_slots.size(); ++i) {
+					init(Entity{EntityIndex::from_index(i)});
+				}
+			}
+
+			m_free_cursor.store(static_cast<int64_t>(m_free.size()), std::memory_order_relaxed);
 		}
 
-		bool destroy_entity(const Entity entity) noexcept {
+		//room for additional entities on top of the destroyed slots that will be reused first
+		void reserve(const size_t additional) {
+			if (additional > m_free.size()) {
+				m_slots.reserve(m_slots.size() + additional - m_free.size());
+			}
+		}
+
+		bool destroy_entity(const Entity entity) {
+			assert(!needs_flush() && "Reserved entities have to be flushed first");
 			const auto index = entity.index().get();
 			if (index >= m_slots.size()) {
 				return false;
 			}
 
-			auto& [next, version, location] = m_slots[index];
+			auto& [version, location] = m_slots[index];
 			if (version != entity.version()) {
 				return false;
 			}
 
-			next = m_head;
-			m_head = entity.index();
 			++version;
-			m_destroyed++;
+			m_free.push_back(entity.index());
+			m_free_cursor.store(static_cast<int64_t>(m_free.size()), std::memory_order_relaxed);
 
 			return true;
 		}
@@ -114,13 +185,14 @@ namespace glaze::ecs {
 			m_slots[index].location.table_row = table_row;
 		}
 
+		//reserved entities that weren't flushed yet don't have a location
 		[[nodiscard]] std::optional<EntityLocation> get_location(const Entity entity) const noexcept {
 			const std::size_t i = entity.index().to_index();
 			if (i >= m_slots.size()) {
 				return std::nullopt;
 			}
-			const auto& [next, version, location] = m_slots[i];
-			if (version != entity.version()) {
+			const auto& [version, location] = m_slots[i];
+			if (version != entity.version() || !location.archetype_id.valid()) {
 				return std::nullopt;
 			}
 			return location;
@@ -131,8 +203,7 @@ namespace glaze::ecs {
 			if (i >= m_slots.size()) {
 				return std::nullopt;
 			}
-			const auto& [next, version, location] = m_slots[i];
-			return Entity{index, version};
+			return Entity{index, m_slots[i].version};
 		}
 
 		[[nodiscard]] bool is_valid(const Entity entity) const noexcept {
@@ -141,16 +212,50 @@ namespace glaze::ecs {
 				return false;
 			}
 
-			const auto& [next, version, location] = m_slots[index];
-			if (version != entity.version()) {
-				return false;
+			return m_slots[index].version == entity.version();
+		}
+
+		//replaces the manager's content, slots take the given versions and get their locations set afterwards
+		//free has to list the destroyed slots in the order they're going to be reused from the back
+		void restore(const std::span<const EntityVersion> versions, const std::span<const EntityIndex> free) {
+			assert(!needs_flush() && "Reserved entities have to be flushed first");
+			m_slots.clear();
+			m_slots.reserve(versions.size());
+			for (const auto version : versions) {
+				m_slots.push_back(Slot{ version, NULL_ENTITY_LOCATION });
 			}
+			m_free.assign(free.begin(), free.end());
+			m_free_cursor.store(static_cast<int64_t>(m_free.size()), std::memory_order_relaxed);
+		}
 
-			return true;
+		//same slots and free list as other, the slot vectors keep their allocations
+		void copy_from(const EntityManager& other) {
+			assert(!needs_flush() && !other.needs_flush() && "Reserved entities have to be flushed first");
+			m_slots = other.m_slots;
+			m_free = other.m_free;
+			m_free_cursor.store(static_cast<int64_t>(m_free.size()), std::memory_order_relaxed);
 		}
 
+		//applies slot versions of another manager on top of this one, the given slots lose their location until they're placed again
+		//the manager grows to slot_count slots and free replaces the free list
+		void patch(const size_t slot_count, const std::span<const EntityIndex> indices, const std::span<const EntityVersion> versions, const std::span<const EntityIndex> free) {
+			assert(!needs_flush() && "Reserved entities have to be flushed first");
+			assert(indices.size() == versions.size());
+			if (slot_count > m_slots.size()) {
+				m_slots.resize(slot_count);
+			}
+			for (size_t i = 0; i < indices.size(); ++i) {
+				m_slots[indices[i].to_index()] = Slot{ versions[i], NULL_ENTITY_LOCATION };
+			}
+			m_free.assign(free.begin(), free.end());
+			m_free_cursor.store(static_cast<int64_t>(m_free.size()), std::memory_order_relaxed);
+		}
+
+		[[nodiscard]] std::span<const Slot> slots() const noexcept { return m_slots; }
+		[[nodiscard]] std::span<const EntityIndex> free_indices() const noexcept { return m_free; }
+
 		[[nodiscard]] size_t size() const noexcept {
-			return m_slots.size() - m_destroyed;
+			return m_slots.size() - m_free.size();
 		}
 
 		[[nodiscard]] size_t max_size() const noexcept {
@@ -159,14 +264,15 @@ namespace glaze::ecs {
 
 		void clear() noexcept {
 			m_slots.clear();
-			m_destroyed = 0;
-			m_head = utils::null_id;;
+			m_free.clear();
+			m_free_cursor.store(0, std::memory_order_relaxed);
 		}
 
 	private:
 		std::vector<Slot> m_slots;
-		size_t m_destroyed = 0;
-		EntityIndex m_head = utils::null_id;
+		//destroyed slots, reused from the back
+		std::vector<EntityIndex> m_free;
+		std::atomic<int64_t> m_free_cursor = 0;
 	};
 }
 
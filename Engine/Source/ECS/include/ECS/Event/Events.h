@@ -0,0 +1,161 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <concepts>
+#include <cstdint>
+#include <iterator>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "Utils/ThreadPool.h"
+
+/*
+	Typed event channel.
+
+	Events are stored in two contiguous buffers: the one being written this frame and the one of the previous frame.
+	update() drops the older buffer and reuses it for the next frame, so an event stays readable for two updates
+	and sending events only allocates when a buffer grows past the size it had two frames ago.
+
+	Every event gets the next id of the channel. Readers keep their own EventCursor with the id of the next event to read,
+	any number of them can read the same events at their own pace. A reader that falls behind by more than one update misses
+	the dropped events.
+
+	Threads of a pool send into their own append buffer without locking, update() appends the buffers to the current frame
+	in thread index order before the swap, so events sent in parallel become readable after the next update.
+ */
+namespace glaze::ecs {
+	//id of the next event a reader will read
+	struct EventCursor {
+		uint64_t next = 0;
+	};
+
+	//events a reader hasn't read yet, the ones of the previous frame first
+	template<typename T>
+	struct EventSpans {
+		std::span<const T> older;
+		std::span<const T> newer;
+
+		template<typename F> requires std::invocable<F&, const T&>
+		void for_each(F&& func) const {
+			for (const auto& event : older) {
+				func(event);
+			}
+			for (const auto& event : newer) {
+				func(event);
+			}
+		}
+
+		[[nodiscard]] size_t size() const noexcept { return older.size() + newer.size(); }
+		[[nodiscard]] bool empty() const noexcept { return older.empty() && newer.empty(); }
+	};
+
+	template<typename T>
+	struct Events {
+		Events() = default;
+
+		//with an append buffer for every thread of pool
+		explicit Events(const utils::ThreadPool& pool)
+			: m_pool(&pool), m_thread_buffers(pool.concurrency()) {
+		}
+
+		void send(const T& event) {
+			current().events.push_back(event);
+		}
+
+		void send(T&& event) {
+			current().events.push_back(std::move(event));
+		}
+
+		template<typename ... Args> requires std::constructible_from<T, Args&&...>
+		T& emplace(Args&& ... args) {
+			return current().events.emplace_back(std::forward<Args>(args)...);
+		}
+
+		void send_batch(const std::span<const T> events) {
+			current().events.insert(current().events.end(), events.begin(), events.end());
+		}
+
+		//appends to the calling thread's buffer, safe to call from every thread of the pool at the same time
+		//the event becomes readable after the next update
+		void send_parallel(T event) {
+			assert(m_pool && "Events have to be created with the pool they're sent from");
+			m_thread_buffers[m_pool->current_thread_index()].events.push_back(std::move(event));
+		}
+
+		//appends the thread buffers to the current frame, drops the events of the previous frame and starts a new one
+		//must not overlap with sending or reading
+		void update() {
+			auto& buffer = current();
+			for (auto& thread_buffer : m_thread_buffers) {
+				std::ranges::move(thread_buffer.events, std::back_inserter(buffer.events));
+				thread_buffer.events.clear();
+			}
+
+			const auto next = buffer.end();
+			m_current ^= 1;
+			current().events.clear();
+			current().first = next;
+		}
+
+		//events sent since the cursor's last read and still stored, advances the cursor past them
+		//the spans are valid until the next event is sent or the next update
+		[[nodiscard]] EventSpans<T> read(EventCursor& cursor) const {
+			const auto unread = [&](const Buffer& buffer) {
+				const auto first = std::clamp(cursor.next, buffer.first, buffer.end());
+				return std::span(buffer.events).subspan(first - buffer.first);
+			};
+
+			const EventSpans<T> spans{ unread(previous()), unread(current()) };
+			cursor.next = current().end();
+			return spans;
+		}
+
+		//cursor which only reads events sent from now on
+		[[nodiscard]] EventCursor cursor() const noexcept {
+			return { current().end() };
+		}
+
+		//drops every stored event, readers continue with the next sent one
+		void clear() noexcept {
+			const auto next = current().end();
+			for (auto& buffer : m_buffers) {
+				buffer.events.clear();
+				buffer.first = next;
+			}
+			for (auto& thread_buffer : m_thread_buffers) {
+				thread_buffer.events.clear();
+			}
+		}
+
+		//stored events of the current and the previous frame
+		[[nodiscard]] size_t size() const noexcept { return m_buffers[0].events.size() + m_buffers[1].events.size(); }
+		[[nodiscard]] bool empty() const noexcept { return size() == 0; }
+
+	private:
+		struct Buffer {
+			std::vector<T> events;
+			//id of events[0]
+			uint64_t first = 0;
+
+			//id of the next event sent to the buffer
+			[[nodiscard]] uint64_t end() const noexcept { return first + static_cast<uint64_t>(events.size()); }
+		};
+
+		//written by one thread each, kept on separate cache lines
+		struct alignas(64) ThreadBuffer {
+			std::vector<T> events;
+		};
+
+		[[nodiscard]] auto& current(this auto& self) noexcept { return self.m_buffers[self.m_current]; }
+		[[nodiscard]] auto& previous(this auto& self) noexcept { return self.m_buffers[self.m_current ^ 1]; }
+
+		std::array<Buffer, 2> m_buffers;
+		size_t m_current = 0;
+
+		const utils::ThreadPool* m_pool = nullptr;
+		std::vector<ThreadBuffer> m_thread_buffers;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,383 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "ECS/Entity.h"
+#include "ECS/Storage/SparseSet/SparseArray.h"
+#include "Utils/Panic.h"
+#include "Utils/ThreadPool.h"
+
+/*
+	Parent child relations between entities.
+
+	Every entity with a parent or with children is a node of one array kept in depth first order:
+	a subtree is a contiguous range starting with its root, followed by the subtrees of its children.
+	Reparenting rotates the subtree's range to its new place and fixes the sizes of its old and new ancestors,
+	so the order is never rebuilt and a change costs the distance the subtree moves.
+
+	Values propagated down the hierarchy, e.g. transforms, are computed in one linear pass over the array,
+	the values of the current path are kept on a stack indexed by depth instead of looking parents up.
+	Subtrees of different roots don't share entities, so they're propagated in parallel.
+
+	World::set_parent and World::remove_parent keep the ChildOf component of an entity in sync with the hierarchy,
+	ChildOf must not be added or removed in any other way.
+ */
+namespace glaze::ecs {
+	//parent of an entity, written by World::set_parent
+	struct ChildOf {
+		Entity parent;
+	};
+
+	struct HierarchyNode {
+		Entity entity;
+		//null for roots
+		Entity parent;
+		uint32_t depth = 0;
+		//nodes of the subtree, this one included
+		uint32_t subtree_size = 1;
+	};
+
+	//direct children of an entity in order, every child is followed by its own subtree so the iterator skips over it
+	struct Children {
+		struct Iterator {
+			using value_type = Entity;
+			using difference_type = std::ptrdiff_t;
+
+			[[nodiscard]] Entity operator*() const noexcept { return node->entity; }
+
+			Iterator& operator++() noexcept {
+				node += node->subtree_size;
+				return *this;
+			}
+
+			Iterator operator++(int) noexcept {
+				auto it = *this;
+				++*this;
+				return it;
+			}
+
+			[[nodiscard]] bool operator==(const Iterator&) const noexcept = default;
+
+			const HierarchyNode* node = nullptr;
+		};
+
+		Children() = default;
+
+		//descendants of an entity, without the entity itself
+		explicit Children(const std::span<const HierarchyNode> descendants) noexcept
+			: m_descendants(descendants) {
+		}
+
+		[[nodiscard]] Iterator begin() const noexcept { return { m_descendants.data() }; }
+		[[nodiscard]] Iterator end() const noexcept { return { m_descendants.data() + m_descendants.size() }; }
+		[[nodiscard]] bool empty() const noexcept { return m_descendants.empty(); }
+
+	private:
+		std::span<const HierarchyNode> m_descendants;
+	};
+
+	struct Hierarchy {
+		//makes child the last child of parent, entities which aren't part of the hierarchy yet are added as roots first
+		//panics if parent is child or one of its descendants
+		void set_parent(const Entity child, const Entity parent) {
+			if (child == parent) {
+				utils::panic("Entity {} can't be its own parent", child);
+			}
+
+			ensure_node(parent);
+			ensure_node(child);
+			const auto child_pos = *position(child);
+			if (in_subtree(*position(parent), child_pos)) {
+				utils::panic("Entity {} is a descendant of {}, it can't become its parent", parent, child);
+			}
+
+			const auto old_parent = m_nodes[child_pos].parent;
+			if (old_parent == parent) {
+				return;
+			}
+
+			if (old_parent.index().valid()) {
+				detach(child_pos);
+				prune(old_parent);
+			}
+			attach(*position(child), parent);
+		}
+
+		//makes the child a root, entities left without a parent and children leave the hierarchy
+		//false if the child has no parent
+		bool remove_parent(const Entity child) {
+			const auto pos = position(child);
+			if (!pos || !m_nodes[*pos].parent.index().valid()) {
+				return false;
+			}
+
+			const auto parent = m_nodes[*pos].parent;
+			detach(*pos);
+			prune(parent);
+			prune(child);
+			return true;
+		}
+
+		//removes an entity without children, e.g. one that is about to be destroyed
+		void remove(const Entity entity) {
+			const auto pos = position(entity);
+			if (!pos) {
+				return;
+			}
+
+			assert(m_nodes[*pos].subtree_size == 1 && "Children have to be detached first");
+			if (!remove_parent(entity)) {
+				prune(entity);
+			}
+		}
+
+		//replaces the hierarchy with the one described by (child, parent) pairs, e.g. the ChildOf components of a loaded world
+		//roots and siblings are ordered by entity, pairs that form a cycle are dropped
+		void rebuild(std::span<const std::pair<Entity, Entity>> links) {
+			clear();
+
+			std::vector<std::pair<Entity, Entity>> by_parent(links.begin(), links.end());
+			std::ranges::sort(by_parent, {}, [](const auto& link) { return std::pair{ link.second, link.first }; });
+
+			//roots are parents which have no parent themselves, the positions mark the children meanwhile
+			for (const auto& [child, parent] : by_parent) {
+				m_positions.insert(child.index(), 0);
+			}
+			std::vector<Entity> roots;
+			for (const auto& [child, parent] : by_parent) {
+				if (!m_positions.contains(parent.index()) && (roots.empty() || roots.back() != parent)) {
+					roots.push_back(parent);
+				}
+			}
+			m_positions.clear();
+
+			struct Pending {
+				Entity entity;
+				Entity parent;
+				uint32_t depth;
+			};
+
+			std::vector<Pending> stack;
+			for (const auto root : roots) {
+				stack.push_back({ root, Entity{}, 0 });
+				while (!stack.empty()) {
+					const auto [entity, parent, depth] = stack.back();
+					stack.pop_back();
+
+					m_positions.insert(entity.index(), static_cast<uint32_t>(m_nodes.size()));
+					m_nodes.push_back({ entity, parent, depth, 1 });
+
+					//pushed in reverse, so the children come out in order
+					const auto [first, last] = std::ranges::equal_range(by_parent, entity, {}, [](const auto& link) { return link.second; });
+					for (auto it = last; it != first;) {
+						--it;
+						stack.push_back({ it->first, entity, depth + 1 });
+					}
+				}
+			}
+
+			//every node comes after its parent, so subtrees are complete by the time they're added to their parent
+			for (size_t i = m_nodes.size(); i-- > 0;) {
+				if (m_nodes[i].parent.index().valid()) {
+					m_nodes[*position(m_nodes[i].parent)].subtree_size += m_nodes[i].subtree_size;
+				}
+			}
+		}
+
+		//replaces the content with a copy of other's
+		void copy_from(const Hierarchy& other) {
+			m_nodes = other.m_nodes;
+			m_positions.copy_from(other.m_positions);
+		}
+
+		void clear() noexcept {
+			m_nodes.clear();
+			m_positions.clear();
+		}
+
+		//every node in depth first order
+		[[nodiscard]] std::span<const HierarchyNode> nodes() const noexcept { return m_nodes; }
+
+		//subtrees of the roots, they don't share entities
+		[[nodiscard]] std::vector<std::span<const HierarchyNode>> subtrees() const {
+			std::vector<std::span<const HierarchyNode>> out;
+			for (size_t i = 0; i < m_nodes.size(); i += m_nodes[i].subtree_size) {
+				out.push_back(std::span(m_nodes).subspan(i, m_nodes[i].subtree_size));
+			}
+			return out;
+		}
+
+		[[nodiscard]] std::optional<Entity> parent(const Entity entity) const noexcept {
+			const auto pos = position(entity);
+			if (!pos || !m_nodes[*pos].parent.index().valid()) {
+				return std::nullopt;
+			}
+			return m_nodes[*pos].parent;
+		}
+
+		[[nodiscard]] Children children(const Entity entity) const noexcept {
+			const auto pos = position(entity);
+			if (!pos) {
+				return {};
+			}
+			return Children{ std::span(m_nodes).subspan(*pos + 1, m_nodes[*pos].subtree_size - 1) };
+		}
+
+		//the entity's subtree, empty if it isn't part of the hierarchy
+		[[nodiscard]] std::span<const HierarchyNode> subtree(const Entity entity) const noexcept {
+			const auto pos = position(entity);
+			if (!pos) {
+				return {};
+			}
+			return std::span(m_nodes).subspan(*pos, m_nodes[*pos].subtree_size);
+		}
+
+		[[nodiscard]] bool contains(const Entity entity) const noexcept { return position(entity).has_value(); }
+		[[nodiscard]] size_t size() const noexcept { return m_nodes.size(); }
+		[[nodiscard]] bool empty() const noexcept { return m_nodes.empty(); }
+
+		//func is invoked with (const HierarchyNode&, const T* parent_value) for every node and returns the node's value
+		//nodes have to be whole subtrees, e.g. nodes() or one of subtrees(), the subtree roots get a null parent value
+		template<typename T, typename F> requires std::is_invocable_r_v<T, F&, const HierarchyNode&, const T*>
+		static void propagate(const std::span<const HierarchyNode> nodes, F&& func) {
+			if (nodes.empty()) {
+				return;
+			}
+
+			//values of the path from the subtree root to the current node
+			std::vector<T> path;
+			const uint32_t base = nodes.front().depth;
+			for (const auto& node : nodes) {
+				const size_t depth = node.depth - base;
+				assert(depth <= path.size() && "Nodes aren't whole subtrees");
+				T value = func(node, depth == 0 ? nullptr : &path[depth - 1]);
+				if (depth < path.size()) {
+					path[depth] = std::move(value);
+				} else {
+					path.push_back(std::move(value));
+				}
+			}
+		}
+
+		template<typename T, typename F> requires std::is_invocable_r_v<T, F&, const HierarchyNode&, const T*>
+		void propagate(F&& func) const {
+			propagate<T>(nodes(), func);
+		}
+
+		//propagates the subtrees of the roots on the pool, func is invoked from several threads at once
+		template<typename T, typename F> requires std::is_invocable_r_v<T, F&, const HierarchyNode&, const T*>
+		void par_propagate(utils::ThreadPool& pool, F&& func) const {
+			const auto roots = subtrees();
+			pool.parallel_for(roots.size(), 1, [&](const size_t begin, const size_t end) {
+				for (size_t i = begin; i < end; ++i) {
+					propagate<T>(roots[i], func);
+				}
+			});
+		}
+
+	private:
+		[[nodiscard]] std::optional<size_t> position(const Entity entity) const noexcept {
+			const auto pos = m_positions.at(entity.index());
+			if (!pos || m_nodes[pos->get()].entity != entity) {
+				return std::nullopt;
+			}
+			return pos->get();
+		}
+
+		[[nodiscard]] bool in_subtree(const size_t pos, const size_t root) const noexcept {
+			return pos >= root && pos < root + m_nodes[root].subtree_size;
+		}
+
+		void ensure_node(const Entity entity) {
+			if (!position(entity)) {
+				m_positions.insert(entity.index(), static_cast<uint32_t>(m_nodes.size()));
+				m_nodes.push_back({ entity, Entity{}, 0, 1 });
+			}
+		}
+
+		//moves the size nodes at from in front of the node at to, returns their new position
+		size_t move_subtree(const size_t from, const size_t size, const size_t to) {
+			const auto nodes = m_nodes.begin();
+			size_t first;
+			size_t affected_begin;
+			size_t affected_end;
+			if (to > from + size) {
+				std::rotate(nodes + from, nodes + from + size, nodes + to);
+				first = to - size;
+				affected_begin = from;
+				affected_end = to;
+			} else if (to < from) {
+				std::rotate(nodes + to, nodes + from, nodes + from + size);
+				first = to;
+				affected_begin = to;
+				affected_end = from + size;
+			} else {
+				return from;
+			}
+
+			for (size_t i = affected_begin; i < affected_end; ++i) {
+				m_positions[m_nodes[i].entity.index()] = static_cast<uint32_t>(i);
+			}
+			return first;
+		}
+
+		//adds size to the subtree sizes of entity and its ancestors
+		void resize_ancestors(Entity entity, const int64_t size) noexcept {
+			while (entity.index().valid()) {
+				auto& node = m_nodes[*position(entity)];
+				node.subtree_size = static_cast<uint32_t>(node.subtree_size + size);
+				entity = node.parent;
+			}
+		}
+
+		//makes the subtree at pos a root at the end of the array
+		void detach(const size_t pos) {
+			const auto node = m_nodes[pos];
+			resize_ancestors(node.parent, -static_cast<int64_t>(node.subtree_size));
+			m_nodes[pos].parent = Entity{};
+
+			const auto first = move_subtree(pos, node.subtree_size, m_nodes.size());
+			for (size_t i = first; i < first + node.subtree_size; ++i) {
+				m_nodes[i].depth -= node.depth;
+			}
+		}
+
+		//moves the root at pos behind the last descendant of parent
+		void attach(const size_t pos, const Entity parent) {
+			const auto size = m_nodes[pos].subtree_size;
+			const auto parent_pos = *position(parent);
+			const auto depth = m_nodes[parent_pos].depth + 1;
+
+			const auto first = move_subtree(pos, size, parent_pos + m_nodes[parent_pos].subtree_size);
+			m_nodes[first].parent = parent;
+			for (size_t i = first; i < first + size; ++i) {
+				m_nodes[i].depth += depth;
+			}
+			resize_ancestors(parent, size);
+		}
+
+		//removes the entity if it's a root without children
+		void prune(const Entity entity) {
+			const auto pos = position(entity);
+			if (!pos || m_nodes[*pos].parent.index().valid() || m_nodes[*pos].subtree_size != 1) {
+				return;
+			}
+
+			move_subtree(*pos, 1, m_nodes.size());
+			m_nodes.pop_back();
+			m_positions.remove(entity.index());
+		}
+
+		std::vector<HierarchyNode> m_nodes;
+		//position of every node in m_nodes
+		SparseArray<EntityIndex, uint32_t> m_positions;
+	};
+}
\ No newline at end of file
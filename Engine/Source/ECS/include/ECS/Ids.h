@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <span>
+#include <vector>
 
 #include "Utils/StrongId.h"
 
@@ -26,6 +27,8 @@ namespace glaze::ecs {
 
 	using BundleId = utils::StrongId<struct BundleIdTag, uint32_t>;
 
+	using SystemId = utils::StrongId<struct SystemIdTag, uint32_t>;
+
 	struct ComponentIdHasher {
 		using is_transparent = void;
 
@@ -0,0 +1,475 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <ranges>
+
+#include "ECS/World.h"
+#include "Utils/ThreadPool.h"
+
+#include "QueryFetch.h"
+#include "QueryFilter.h"
+
+namespace glaze::ecs {
+	namespace details {
+		template<typename F, typename Tuple>
+		inline constexpr bool is_applicable_v = false;
+
+		template<typename F, typename ... As>
+		inline constexpr bool is_applicable_v<F, std::tuple<As...>> = std::is_invocable_v<F, As...>;
+
+		//filters don't have a storage type, only component terms do
+		template<typename T>
+		inline constexpr bool is_sparse_component_v = false;
+
+		template<typename T> requires requires { QueryFetch<T>::STORAGE_TYPE; }
+		inline constexpr bool is_sparse_component_v<T> = QueryFetch<T>::STORAGE_TYPE == StorageType::SparseSet;
+	}
+
+	template<QueryTerm ... Ts> requires (sizeof ... (Ts) > 0)
+	struct Query {
+		using State = std::tuple<typename QueryFetch<Ts>::State...>;
+		using Cursors = std::tuple<typename QueryFetch<Ts>::Cursor...>;
+		using Items = decltype(std::tuple_cat(std::declval<typename QueryFetch<Ts>::Item>()...));
+		using Slices = decltype(std::tuple_cat(std::declval<typename QueryFetch<Ts>::Slice>()...));
+
+		//all terms live in tables, so every entity of a matched table matches as well
+		static constexpr bool IS_DENSE = (QueryFetch<Ts>::IS_DENSE && ...);
+		//some terms (Added, Changed) have to be checked for every entity of a matched archetype
+		static constexpr bool FILTERS_ROWS = (QueryFetch<Ts>::FILTERS_ROWS || ...);
+
+		//every term is a sparse set component, so the matching entities can also be found by joining the sets
+		static constexpr bool IS_SPARSE_JOIN = (details::is_sparse_component_v<Ts> && ...);
+
+		static constexpr size_t DEFAULT_MIN_BATCH_SIZE = 1024;
+		static constexpr size_t SPARSE_PREFETCH_DISTANCE = 8;
+
+		explicit Query(World& world)
+			: m_state(QueryFetch<Ts>::init_state(world.component_manager())...) {
+			[&]<size_t ... I>(std::index_sequence<I...>) {
+				(add_required_component(QueryFetch<Ts>::required_component(std::get<I>(m_state))), ...);
+				(add_excluded_component(QueryFetch<Ts>::excluded_component(std::get<I>(m_state))), ...);
+			}(std::index_sequence_for<Ts...>{});
+
+			update_archetypes(world.archetype_manager());
+		}
+
+		//archetypes are never removed, so only the ones created since the last call have to be matched
+		//candidates come either from the rarest required component in the ComponentIndex or from the new archetypes, whichever is smaller
+		void update_archetypes(const ArchetypeManager& archetype_manager) {
+			const auto version = archetype_manager.version();
+			if (version == m_archetype_version) {
+				return;
+			}
+
+			const size_t first_new = m_archetype_version.to_index();
+			const size_t new_count = version.to_index() - first_new;
+
+			const ArchetypeRecordMap* smallest = nullptr;
+			const auto& component_index = archetype_manager.component_index();
+			for (const auto component_id : m_required) {
+				const auto it = component_index.find(component_id);
+				if (it == component_index.end()) {
+					//no archetype has this component yet, the ones created later will be new to us anyway
+					m_archetype_version = version;
+					return;
+				}
+
+				if (!smallest || it->second.size() < smallest->size()) {
+					smallest = &it->second;
+				}
+			}
+
+			if (smallest && smallest->size() < new_count) {
+				std::vector<ArchetypeId> candidates;
+				candidates.reserve(smallest->size());
+				for (const auto archetype_id : *smallest | std::views::keys) {
+					if (archetype_id.to_index() >= first_new) {
+						candidates.push_back(archetype_id);
+					}
+				}
+
+				std::ranges::sort(candidates);
+				for (const auto archetype_id : candidates) {
+					const auto& archetype = archetype_manager[archetype_id];
+					if (matches_mask(archetype.mask())) {
+						try_add_archetype(archetype);
+					}
+				}
+			} else {
+				//masks are stored contiguously, so rejecting an archetype doesn't touch the archetype itself
+				const auto archetypes = archetype_manager.archetypes();
+				const auto masks = archetype_manager.masks();
+				for (size_t i = first_new; i < version.to_index(); ++i) {
+					if (matches_mask(masks[i])) {
+						try_add_archetype(archetypes[i]);
+					}
+				}
+			}
+
+			m_archetype_version = version;
+		}
+
+		//func is invoked with (Entity, Items...) or (Items...)
+		template<typename F>
+		void for_each(World& world, F&& func) {
+			update_archetypes(world.archetype_manager());
+			const auto ticks = begin_run(world);
+
+			auto& storage = world.storage();
+			for (const auto archetype_id : m_archetypes) {
+				const auto& archetype = world.archetype_manager()[archetype_id];
+				if (archetype.empty()) {
+					continue;
+				}
+
+				const auto cursors = make_cursors(storage[archetype.table_id()], storage, ticks);
+				if (!may_pass(cursors)) {
+					continue;
+				}
+
+				for (const auto& [entity, table_row] : archetype.entities()) {
+					if (filter(cursors, entity, table_row)) {
+						invoke(func, entity, fetch(cursors, entity, table_row));
+					}
+				}
+			}
+		}
+
+		//func is invoked once per matched table with (std::span<const Entity>, std::span<Ts>...) or (std::span<Ts>...)
+		//every span covers the whole table, or one chunk of a chunked table, so the loop over it can be vectorized by the compiler
+		template<typename F>
+		void for_each_chunk(World& world, F&& func) {
+			static_assert(IS_DENSE, "Chunk iteration requires all query terms to be stored in tables");
+			static_assert(!FILTERS_ROWS, "Chunk iteration can't skip entities filtered out by Added or Changed");
+			update_archetypes(world.archetype_manager());
+			const auto ticks = begin_run(world);
+
+			auto& storage = world.storage();
+			for (const auto table_id : m_tables) {
+				auto& table = storage[table_id];
+				const auto count = table.entity_count();
+				if (count == 0) {
+					continue;
+				}
+
+				const auto cursors = make_cursors(table, storage, ticks);
+				for (const auto rows : table.chunks()) {
+					invoke(func, table.entities(rows), slice(cursors, rows.offset, rows.length));
+				}
+			}
+		}
+
+		//walks the dense array of the smallest sparse set and probes the others, whose slots are prefetched a few entities ahead
+		//visits the same entities as for_each without touching archetypes, func is invoked with (Entity, Items...) or (Items...)
+		template<typename F>
+		void for_each_sparse(World& world, F&& func) {
+			static_assert(IS_SPARSE_JOIN, "Sparse iteration requires all query terms to be sparse set components");
+			const auto ticks = begin_run(world);
+
+			std::array<ComponentSparseSet*, sizeof ... (Ts)> sets{};
+			[&]<size_t ... I>(std::index_sequence<I...>) {
+				((sets[I] = world.storage().sparse_sets.at(std::get<I>(m_state)).transform([](const auto sparse_set) { return &sparse_set.get(); }).value_or(nullptr)), ...);
+			}(std::index_sequence_for<Ts...>{});
+
+			//a set is only created once a bundle with its component is registered
+			if (std::ranges::contains(sets, nullptr)) {
+				return;
+			}
+
+			const Cursors cursors = [&]<size_t ... I>(std::index_sequence<I...>) {
+				return Cursors{ typename QueryFetch<Ts>::Cursor{ sets[I], ticks }... };
+			}(std::index_sequence_for<Ts...>{});
+
+			const auto driver = static_cast<size_t>(std::ranges::min_element(sets, {}, &ComponentSparseSet::size) - sets.begin());
+			const auto indices = sets[driver]->entity_indices();
+			const auto& entity_manager = world.entity_manager();
+
+			std::array<TableRow, sizeof ... (Ts)> rows;
+			for (size_t i = 0; i < indices.size(); ++i) {
+				if (i + SPARSE_PREFETCH_DISTANCE < indices.size()) {
+					for (size_t s = 0; s < sets.size(); ++s) {
+						if (s != driver) {
+							sets[s]->prefetch(indices[i + SPARSE_PREFETCH_DISTANCE]);
+						}
+					}
+				}
+
+				const auto index = indices[i];
+				bool found = true;
+				for (size_t s = 0; s < sets.size() && found; ++s) {
+					const auto row = s == driver ? std::make_optional(TableRow::from_index(i)) : sets[s]->dense_row(index);
+					found = row.has_value();
+					rows[s] = row.value_or(TableRow{});
+				}
+
+				if (found) {
+					invoke(func, utils::value_or_panic_debug(entity_manager.entity(index)), fetch_rows(cursors, rows));
+				}
+			}
+		}
+
+		//splits every matched table (or archetype for queries with sparse terms) into row ranges and runs them on the pool
+		//func is invoked concurrently, so it must only touch the fetched components and thread safe state
+		template<typename F>
+		void par_for_each(World& world, utils::ThreadPool& pool, F&& func, const size_t min_batch_size = DEFAULT_MIN_BATCH_SIZE) {
+			collect_batches(world, pool, min_batch_size);
+
+			pool.parallel_for(m_batches.size(), 1, [&](const size_t begin, const size_t end) {
+				for (size_t i = begin; i < end; ++i) {
+					run_batch(m_batches[i], func);
+				}
+			});
+		}
+
+		//same as for_each_chunk, but every span covers one batch of rows instead of the whole table
+		template<typename F>
+		void par_for_each_chunk(World& world, utils::ThreadPool& pool, F&& func, const size_t min_batch_size = DEFAULT_MIN_BATCH_SIZE) {
+			static_assert(IS_DENSE, "Chunk iteration requires all query terms to be stored in tables");
+			static_assert(!FILTERS_ROWS, "Chunk iteration can't skip entities filtered out by Added or Changed");
+			collect_batches(world, pool, min_batch_size);
+
+			pool.parallel_for(m_batches.size(), 1, [&](const size_t begin, const size_t end) {
+				for (size_t i = begin; i < end; ++i) {
+					const auto& batch = m_batches[i];
+					invoke(func, batch.entities, slice(batch.cursors, batch.offset, batch.entities.size()));
+				}
+			});
+		}
+
+		[[nodiscard]] bool matches(const Archetype& archetype) const noexcept {
+			return [&]<size_t ... I>(std::index_sequence<I...>) {
+				return (QueryFetch<Ts>::matches(std::get<I>(m_state), archetype) && ...);
+			}(std::index_sequence_for<Ts...>{});
+		}
+
+		//(mask & required) == required && (mask & excluded) == 0
+		//exact unless a term isn't expressible as a mask or a component id doesn't fit, in which case matches() decides
+		[[nodiscard]] bool matches_mask(const ComponentMask& mask) const noexcept {
+			return mask.contains_all(m_required_mask) && !mask.intersects(m_excluded_mask);
+		}
+
+		//components the terms read and write, used to decide which systems can run at the same time
+		[[nodiscard]] ComponentAccess access() const {
+			ComponentAccess access;
+			[&]<size_t ... I>(std::index_sequence<I...>) {
+				(QueryFetch<Ts>::add_access(std::get<I>(m_state), access), ...);
+			}(std::index_sequence_for<Ts...>{});
+			return access;
+		}
+
+		[[nodiscard]] std::span<const ArchetypeId> archetypes() const noexcept { return m_archetypes; }
+		[[nodiscard]] std::span<const TableId> tables() const noexcept { return m_tables; }
+		[[nodiscard]] ArchetypeVersion archetype_version() const noexcept { return m_archetype_version; }
+		//tick of the previous iteration, Added and Changed see only writes newer than it
+		[[nodiscard]] Tick last_run() const noexcept { return m_last_run; }
+
+		//clamps the last run after World::check_change_ticks did a pass, Schedule does it for the queries of its systems
+		void check_change_ticks(const Tick this_run) noexcept {
+			m_last_run.clamp(this_run);
+		}
+		[[nodiscard]] const State& state() const noexcept { return m_state; }
+
+	private:
+		void add_required_component(const std::optional<ComponentId> component_id) {
+			if (!component_id) {
+				return;
+			}
+
+			m_mask_exact &= m_required_mask.set(*component_id);
+			if (!std::ranges::contains(m_required, *component_id)) {
+				m_required.push_back(*component_id);
+			}
+		}
+
+		void add_excluded_component(const std::optional<ComponentId> component_id) {
+			if (component_id) {
+				m_mask_exact &= m_excluded_mask.set(*component_id);
+			}
+		}
+
+		//expects matches_mask(archetype.mask()) to hold already
+		void try_add_archetype(const Archetype& archetype) {
+			if (!m_mask_exact && !matches(archetype)) {
+				return;
+			}
+
+			m_archetypes.push_back(archetype.id());
+			if (IS_DENSE && !std::ranges::contains(m_tables, archetype.table_id())) {
+				m_tables.push_back(archetype.table_id());
+			}
+		}
+
+		//dense queries batch table rows, the others batch archetype entities which know their table row
+		using BatchEntities = std::conditional_t<IS_DENSE, std::span<const Entity>, std::span<const ArchetypeEntity>>;
+
+		struct Batch {
+			Cursors cursors;
+			BatchEntities entities;
+			size_t offset;
+		};
+
+		void collect_batches(World& world, const utils::ThreadPool& pool, const size_t min_batch_size) {
+			update_archetypes(world.archetype_manager());
+			const auto ticks = begin_run(world);
+			m_batches.clear();
+
+			auto& storage = world.storage();
+			const size_t max_batches = pool.concurrency() * 4;
+
+			const auto batch_size_for = [&](const size_t count) {
+				return std::max({min_batch_size, size_t{1}, (count + max_batches - 1) / max_batches});
+			};
+
+			//first is the table row of entities[0], batches never cross a chunk of a chunked table
+			const auto push_batches = [&](const Cursors& cursors, const BatchEntities entities, const size_t first, const size_t batch_size) {
+				const size_t count = entities.size();
+				for (size_t offset = 0; offset < count; offset += batch_size) {
+					m_batches.push_back(Batch{ cursors, entities.subspan(offset, std::min(batch_size, count - offset)), first + offset });
+				}
+			};
+
+			if constexpr (IS_DENSE) {
+				for (const auto table_id : m_tables) {
+					auto& table = storage[table_id];
+					if (table.entity_count() == 0) {
+						continue;
+					}
+
+					const auto cursors = make_cursors(table, storage, ticks);
+					if (!may_pass(cursors)) {
+						continue;
+					}
+
+					const size_t batch_size = batch_size_for(table.entity_count());
+					for (const auto rows : table.chunks()) {
+						push_batches(cursors, table.entities(rows), rows.offset, batch_size);
+					}
+				}
+			} else {
+				for (const auto archetype_id : m_archetypes) {
+					const auto& archetype = world.archetype_manager()[archetype_id];
+					if (archetype.empty()) {
+						continue;
+					}
+
+					const auto cursors = make_cursors(storage[archetype.table_id()], storage, ticks);
+					if (may_pass(cursors)) {
+						push_batches(cursors, archetype.entities(), 0, batch_size_for(archetype.entities().size()));
+					}
+				}
+			}
+		}
+
+		template<typename F>
+		static void run_batch(const Batch& batch, F& func) {
+			if constexpr (IS_DENSE) {
+				for (size_t i = 0; i < batch.entities.size(); ++i) {
+					const auto entity = batch.entities[i];
+					const auto table_row = TableRow::from_index(batch.offset + i);
+					if (filter(batch.cursors, entity, table_row)) {
+						invoke(func, entity, fetch(batch.cursors, entity, table_row));
+					}
+				}
+			} else {
+				for (const auto& [entity, table_row] : batch.entities) {
+					if (filter(batch.cursors, entity, table_row)) {
+						invoke(func, entity, fetch(batch.cursors, entity, table_row));
+					}
+				}
+			}
+		}
+
+		//every iteration is a run of its own, so the next one sees the writes made by this one and anything after
+		[[nodiscard]] RunTicks begin_run(World& world) noexcept {
+			const RunTicks ticks{ m_last_run, world.increment_change_tick() };
+			m_last_run = ticks.this_run;
+			return ticks;
+		}
+
+		[[nodiscard]] Cursors make_cursors(Table& table, Storage& storage, const RunTicks ticks) const noexcept {
+			return [&]<size_t ... I>(std::index_sequence<I...>) {
+				return Cursors{ QueryFetch<Ts>::cursor(std::get<I>(m_state), table, storage, ticks)... };
+			}(std::index_sequence_for<Ts...>{});
+		}
+
+		//checked once per archetype before any entity, so Added and Changed skip tables nobody wrote to
+		[[nodiscard]] static bool may_pass(const Cursors& cursors) noexcept {
+			if constexpr (FILTERS_ROWS) {
+				return [&]<size_t ... I>(std::index_sequence<I...>) {
+					return (may_pass_term<Ts>(std::get<I>(cursors)) && ...);
+				}(std::index_sequence_for<Ts...>{});
+			} else {
+				return true;
+			}
+		}
+
+		template<typename T>
+		[[nodiscard]] static bool may_pass_term(const typename QueryFetch<T>::Cursor& cursor) noexcept {
+			if constexpr (QueryFetch<T>::FILTERS_ROWS) {
+				return QueryFetch<T>::may_pass(cursor);
+			} else {
+				return true;
+			}
+		}
+
+		[[nodiscard]] static bool filter(const Cursors& cursors, const Entity entity, const TableRow table_row) noexcept {
+			if constexpr (FILTERS_ROWS) {
+				return [&]<size_t ... I>(std::index_sequence<I...>) {
+					return (filter_term<Ts>(std::get<I>(cursors), entity, table_row) && ...);
+				}(std::index_sequence_for<Ts...>{});
+			} else {
+				return true;
+			}
+		}
+
+		template<typename T>
+		[[nodiscard]] static bool filter_term(const typename QueryFetch<T>::Cursor& cursor, const Entity entity, const TableRow table_row) noexcept {
+			if constexpr (QueryFetch<T>::FILTERS_ROWS) {
+				return QueryFetch<T>::filter(cursor, entity, table_row);
+			} else {
+				return true;
+			}
+		}
+
+		[[nodiscard]] static Items fetch(const Cursors& cursors, const Entity entity, const TableRow table_row) noexcept {
+			return [&]<size_t ... I>(std::index_sequence<I...>) {
+				return std::tuple_cat(QueryFetch<Ts>::fetch(std::get<I>(cursors), entity, table_row)...);
+			}(std::index_sequence_for<Ts...>{});
+		}
+
+		[[nodiscard]] static Items fetch_rows(const Cursors& cursors, const std::array<TableRow, sizeof ... (Ts)>& rows) noexcept {
+			return [&]<size_t ... I>(std::index_sequence<I...>) {
+				return std::tuple_cat(QueryFetch<Ts>::fetch_row(std::get<I>(cursors), rows[I])...);
+			}(std::index_sequence_for<Ts...>{});
+		}
+
+		[[nodiscard]] static Slices slice(const Cursors& cursors, const size_t offset, const size_t length) noexcept {
+			return [&]<size_t ... I>(std::index_sequence<I...>) {
+				return std::tuple_cat(QueryFetch<Ts>::slice(std::get<I>(cursors), offset, length)...);
+			}(std::index_sequence_for<Ts...>{});
+		}
+
+		//passes head (an entity or a span of entities) only if func accepts it
+		template<typename F, typename Head, typename Tuple>
+		static void invoke(F& func, const Head head, Tuple&& items) {
+			if constexpr (details::is_applicable_v<F&, decltype(std::tuple_cat(std::tuple<Head>{}, std::declval<Tuple>()))>) {
+				std::apply(func, std::tuple_cat(std::tuple<Head>{head}, std::forward<Tuple>(items)));
+			} else {
+				std::apply(func, std::forward<Tuple>(items));
+			}
+		}
+
+		State m_state;
+		std::vector<ComponentId> m_required;
+		ComponentMask m_required_mask;
+		ComponentMask m_excluded_mask;
+		bool m_mask_exact = (QueryFetch<Ts>::MATCHED_BY_MASK && ...);
+		ArchetypeVersion m_archetype_version = FIRST_ARCHETYPE_VERSION;
+		Tick m_last_run;
+		std::vector<ArchetypeId> m_archetypes;
+		std::vector<TableId> m_tables;
+		std::vector<Batch> m_batches;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <tuple>
+
+#include "ECS/Archetype/Archetype.h"
+#include "ECS/Component/ComponentAccess.h"
+#include "ECS/Component/ComponentManager.h"
+#include "ECS/Storage/Storage.h"
+
+/*
+	QueryFetch describes how a single query term is matched against archetypes and fetched from storage.
+
+	Component terms (T or const T) yield one reference per entity, fetching a mutable one stamps the component as changed.
+	The state is resolved once when a query is created, the cursor once per archetype and the item once per entity,
+	so the per entity path never touches component ids or sparse lookups for table components.
+	Table components can also be sliced into a contiguous span covering a range of table rows.
+ */
+namespace glaze::ecs {
+	//storage of a single component in a table or a sparse set, null if the table doesn't have the component
+	template<typename T>
+	struct ComponentCursor {
+		using Store = std::conditional_t<get_storage_type<std::remove_const_t<T>>() == StorageType::Table, Column, ComponentSparseSet>;
+
+		[[nodiscard]] static ComponentCursor make(const ComponentId id, Table& table, Storage& storage, const RunTicks ticks) noexcept {
+			if constexpr (std::is_same_v<Store, Column>) {
+				return { table.at(id).transform([](const auto column) { return &column.get(); }).value_or(nullptr), ticks };
+			} else {
+				return { storage.sparse_sets.at(id).transform([](const auto sparse_set) { return &sparse_set.get(); }).value_or(nullptr), ticks };
+			}
+		}
+
+		Store* store = nullptr;
+		RunTicks ticks;
+	};
+
+	template<typename T>
+	struct QueryFetch {
+		using ComponentType = std::remove_const_t<T>;
+		static_assert(Component<ComponentType>, "Query term has to be a component or a query filter");
+
+		static constexpr StorageType STORAGE_TYPE = get_storage_type<ComponentType>();
+		static constexpr bool IS_DENSE = STORAGE_TYPE == StorageType::Table;
+		static constexpr bool READ_ONLY = std::is_const_v<T>;
+		//matches() is fully described by required_component and excluded_component
+		static constexpr bool MATCHED_BY_MASK = true;
+		//filter() has to be checked for every entity of a matched archetype, may_pass() once per archetype before that
+		static constexpr bool FILTERS_ROWS = false;
+
+		using State = ComponentId;
+		using Cursor = ComponentCursor<T>;
+		using Item = std::tuple<T&>;
+		using Slice = std::tuple<std::span<T>>;
+
+		[[nodiscard]] static State init_state(ComponentManager& component_manager) {
+			return component_manager.register_component<ComponentType>();
+		}
+
+		//component every matched archetype must have, used to start matching from the rarest one
+		[[nodiscard]] static std::optional<ComponentId> required_component(const State& state) noexcept { return state; }
+		//component no matched archetype may have
+		[[nodiscard]] static std::optional<ComponentId> excluded_component(const State&) noexcept { return std::nullopt; }
+
+		[[nodiscard]] static bool matches(const State& state, const Archetype& archetype) noexcept {
+			return archetype.has_component(state);
+		}
+
+		//mutable terms write the component and its change ticks
+		static void add_access(const State& state, ComponentAccess& access) {
+			if constexpr (READ_ONLY) {
+				access.add_read(state);
+			} else {
+				access.add_write(state);
+			}
+		}
+
+		[[nodiscard]] static Cursor cursor(const State& state, Table& table, Storage& storage, const RunTicks ticks) noexcept {
+			const auto cursor = Cursor::make(state, table, storage, ticks);
+			assert(cursor.store && "Matched archetype doesn't store the component");
+			return cursor;
+		}
+
+		//mutable access marks the component as changed
+		[[nodiscard]] static Item fetch(const Cursor cursor, const Entity entity, const TableRow table_row) noexcept {
+			if constexpr (IS_DENSE) {
+				if constexpr (!READ_ONLY) {
+					cursor.store->mark_changed(table_row.to_index(), cursor.ticks.this_run);
+				}
+				return Item{ *cursor.store->data().template get<ComponentType>(table_row.to_index()) };
+			} else {
+				if constexpr (!READ_ONLY) {
+					cursor.store->mark_changed(entity, cursor.ticks.this_run);
+				}
+				return Item{ utils::value_or_panic_debug(cursor.store->template get<ComponentType>(entity)) };
+			}
+		}
+
+		//sparse set components found by joining sets, row is the entity's row in the set's dense array
+		[[nodiscard]] static Item fetch_row(const Cursor cursor, const TableRow row) noexcept requires (!IS_DENSE) {
+			if constexpr (!READ_ONLY) {
+				cursor.store->mark_row_changed(row, cursor.ticks.this_run);
+			}
+			return Item{ cursor.store->template get_row<T>(row) };
+		}
+
+		[[nodiscard]] static Slice slice(const Cursor cursor, const size_t offset, const size_t length) noexcept {
+			static_assert(IS_DENSE, "Only table components can be sliced");
+			static_assert(!std::is_empty_v<ComponentType>, "Zero sized components have no column data to slice");
+			if constexpr (!READ_ONLY) {
+				cursor.store->mark_changed(offset, length, cursor.ticks.this_run);
+			}
+			return Slice{ cursor.store->data().template get_slice<ComponentType>(offset, length) };
+		}
+	};
+
+	template<typename T>
+	concept QueryTerm = requires(const typename QueryFetch<T>::State& state, ComponentAccess& access) {
+		typename QueryFetch<T>::State;
+		QueryFetch<T>::add_access(state, access);
+		typename QueryFetch<T>::Cursor;
+		typename QueryFetch<T>::Item;
+		typename QueryFetch<T>::Slice;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,294 @@
+#pragma once
+
+#include <variant>
+
+#include "QueryFetch.h"
+
+/*
+	Query terms that only narrow down the matched archetypes (With, Without, Or),
+	narrow down the matched entities by change ticks (Added, Changed)
+	or fetch a component that may be missing (Optional).
+
+	Query<Position, With<Player>, Without<Dead>, Optional<Velocity>>
+	invokes the callback with (Position&, Velocity*) for every player that isn't dead.
+	Query<const Transform, Changed<Transform>> visits only entities whose transform was written since the query ran last.
+ */
+namespace glaze::ecs {
+	template<Component T>
+	struct With {};
+
+	template<Component T>
+	struct Without {};
+
+	template<typename T>
+	struct Optional {};
+
+	template<typename ... Fs>
+	struct Or {};
+
+	//component was added since the query ran last
+	template<Component T>
+	struct Added {};
+
+	//component was added or mutably accessed since the query ran last
+	template<Component T>
+	struct Changed {};
+
+	template<Component T>
+	struct QueryFetch<With<T>> {
+		static constexpr bool IS_DENSE = get_storage_type<T>() == StorageType::Table;
+		static constexpr bool READ_ONLY = true;
+		static constexpr bool MATCHED_BY_MASK = true;
+		static constexpr bool FILTERS_ROWS = false;
+
+		using State = ComponentId;
+		using Cursor = std::monostate;
+		using Item = std::tuple<>;
+		using Slice = std::tuple<>;
+
+		[[nodiscard]] static State init_state(ComponentManager& component_manager) {
+			return component_manager.register_component<T>();
+		}
+
+		[[nodiscard]] static std::optional<ComponentId> required_component(const State& state) noexcept { return state; }
+		[[nodiscard]] static std::optional<ComponentId> excluded_component(const State&) noexcept { return std::nullopt; }
+
+		[[nodiscard]] static bool matches(const State& state, const Archetype& archetype) noexcept {
+			return archetype.has_component(state);
+		}
+
+		//only the archetype is looked at, never the component data
+		static void add_access(const State&, ComponentAccess&) noexcept {}
+
+		[[nodiscard]] static Cursor cursor(const State&, Table&, Storage&, const RunTicks) noexcept { return {}; }
+		[[nodiscard]] static Item fetch(const Cursor, const Entity, const TableRow) noexcept { return {}; }
+		[[nodiscard]] static Slice slice(const Cursor, const size_t, const size_t) noexcept { return {}; }
+	};
+
+	template<Component T>
+	struct QueryFetch<Without<T>> {
+		static constexpr bool IS_DENSE = get_storage_type<T>() == StorageType::Table;
+		static constexpr bool READ_ONLY = true;
+		static constexpr bool MATCHED_BY_MASK = true;
+		static constexpr bool FILTERS_ROWS = false;
+
+		using State = ComponentId;
+		using Cursor = std::monostate;
+		using Item = std::tuple<>;
+		using Slice = std::tuple<>;
+
+		[[nodiscard]] static State init_state(ComponentManager& component_manager) {
+			return component_manager.register_component<T>();
+		}
+
+		[[nodiscard]] static std::optional<ComponentId> required_component(const State&) noexcept { return std::nullopt; }
+		[[nodiscard]] static std::optional<ComponentId> excluded_component(const State& state) noexcept { return state; }
+
+		[[nodiscard]] static bool matches(const State& state, const Archetype& archetype) noexcept {
+			return !archetype.has_component(state);
+		}
+
+		//only the archetype is looked at, never the component data
+		static void add_access(const State&, ComponentAccess&) noexcept {}
+
+		[[nodiscard]] static Cursor cursor(const State&, Table&, Storage&, const RunTicks) noexcept { return {}; }
+		[[nodiscard]] static Item fetch(const Cursor, const Entity, const TableRow) noexcept { return {}; }
+		[[nodiscard]] static Slice slice(const Cursor, const size_t, const size_t) noexcept { return {}; }
+	};
+
+	//yields T* which is null for entities without the component
+	template<typename T>
+	struct QueryFetch<Optional<T>> {
+		using ComponentType = std::remove_const_t<T>;
+		static_assert(Component<ComponentType>, "Optional query term has to wrap a component");
+
+		static constexpr bool IS_DENSE = get_storage_type<ComponentType>() == StorageType::Table;
+		static constexpr bool READ_ONLY = std::is_const_v<T>;
+		static constexpr bool MATCHED_BY_MASK = true;
+		static constexpr bool FILTERS_ROWS = false;
+
+		using State = ComponentId;
+		using Cursor = ComponentCursor<T>;
+		using Item = std::tuple<T*>;
+		using Slice = std::tuple<std::span<T>>;
+
+		[[nodiscard]] static State init_state(ComponentManager& component_manager) {
+			return component_manager.register_component<ComponentType>();
+		}
+
+		[[nodiscard]] static std::optional<ComponentId> required_component(const State&) noexcept { return std::nullopt; }
+		[[nodiscard]] static std::optional<ComponentId> excluded_component(const State&) noexcept { return std::nullopt; }
+		[[nodiscard]] static bool matches(const State&, const Archetype&) noexcept { return true; }
+
+		static void add_access(const State& state, ComponentAccess& access) {
+			if constexpr (READ_ONLY) {
+				access.add_read(state);
+			} else {
+				access.add_write(state);
+			}
+		}
+
+		[[nodiscard]] static Cursor cursor(const State& state, Table& table, Storage& storage, const RunTicks ticks) noexcept {
+			return Cursor::make(state, table, storage, ticks);
+		}
+
+		[[nodiscard]] static Item fetch(const Cursor cursor, const Entity entity, const TableRow table_row) noexcept {
+			if (!cursor.store) {
+				return Item{ nullptr };
+			}
+
+			if constexpr (IS_DENSE) {
+				if constexpr (!READ_ONLY) {
+					cursor.store->mark_changed(table_row.to_index(), cursor.ticks.this_run);
+				}
+				return Item{ cursor.store->data().template get<ComponentType>(table_row.to_index()) };
+			} else {
+				if constexpr (!READ_ONLY) {
+					cursor.store->mark_changed(entity, cursor.ticks.this_run);
+				}
+				return Item{ cursor.store->template get<ComponentType>(entity).transform([](const auto c) { return &c.get(); }).value_or(nullptr) };
+			}
+		}
+
+		//empty span if the table doesn't have the column
+		[[nodiscard]] static Slice slice(const Cursor cursor, const size_t offset, const size_t length) noexcept {
+			static_assert(IS_DENSE, "Only table components can be sliced");
+			static_assert(!std::is_empty_v<ComponentType>, "Zero sized components have no column data to slice");
+			if (!cursor.store) {
+				return Slice{};
+			}
+			if constexpr (!READ_ONLY) {
+				cursor.store->mark_changed(offset, length, cursor.ticks.this_run);
+			}
+			return Slice{ cursor.store->data().template get_slice<ComponentType>(offset, length) };
+		}
+	};
+
+	//matches archetypes matched by any of the filters
+	//either all filters narrow down archetypes or all of them narrow down entities, mixing both isn't supported
+	template<typename ... Fs>
+	struct QueryFetch<Or<Fs...>> {
+		static_assert(sizeof ... (Fs) > 0, "Or needs at least one filter");
+		static_assert((std::is_same_v<typename QueryFetch<Fs>::Item, std::tuple<>> && ...), "Or accepts only filters");
+
+		static constexpr bool IS_DENSE = (QueryFetch<Fs>::IS_DENSE && ...);
+		static constexpr bool READ_ONLY = true;
+		static constexpr bool MATCHED_BY_MASK = false;
+		static constexpr bool FILTERS_ROWS = (QueryFetch<Fs>::FILTERS_ROWS || ...);
+		static_assert(FILTERS_ROWS == (QueryFetch<Fs>::FILTERS_ROWS && ...), "Or can't mix archetype and entity filters");
+
+		using State = std::tuple<typename QueryFetch<Fs>::State...>;
+		using Cursor = std::tuple<typename QueryFetch<Fs>::Cursor...>;
+		using Item = std::tuple<>;
+		using Slice = std::tuple<>;
+
+		[[nodiscard]] static State init_state(ComponentManager& component_manager) {
+			return State{ QueryFetch<Fs>::init_state(component_manager)... };
+		}
+
+		[[nodiscard]] static std::optional<ComponentId> required_component(const State&) noexcept { return std::nullopt; }
+		[[nodiscard]] static std::optional<ComponentId> excluded_component(const State&) noexcept { return std::nullopt; }
+
+		[[nodiscard]] static bool matches(const State& state, const Archetype& archetype) noexcept {
+			return [&]<size_t ... I>(std::index_sequence<I...>) {
+				return (QueryFetch<Fs>::matches(std::get<I>(state), archetype) || ...);
+			}(std::index_sequence_for<Fs...>{});
+		}
+
+		static void add_access(const State& state, ComponentAccess& access) {
+			[&]<size_t ... I>(std::index_sequence<I...>) {
+				(QueryFetch<Fs>::add_access(std::get<I>(state), access), ...);
+			}(std::index_sequence_for<Fs...>{});
+		}
+
+		[[nodiscard]] static Cursor cursor(const State& state, Table& table, Storage& storage, const RunTicks ticks) noexcept {
+			return [&]<size_t ... I>(std::index_sequence<I...>) {
+				return Cursor{ QueryFetch<Fs>::cursor(std::get<I>(state), table, storage, ticks)... };
+			}(std::index_sequence_for<Fs...>{});
+		}
+
+		[[nodiscard]] static Item fetch(const Cursor&, const Entity, const TableRow) noexcept { return {}; }
+		[[nodiscard]] static Slice slice(const Cursor&, const size_t, const size_t) noexcept { return {}; }
+
+		[[nodiscard]] static bool may_pass(const Cursor& cursor) noexcept requires FILTERS_ROWS {
+			return [&]<size_t ... I>(std::index_sequence<I...>) {
+				return (QueryFetch<Fs>::may_pass(std::get<I>(cursor)) || ...);
+			}(std::index_sequence_for<Fs...>{});
+		}
+
+		[[nodiscard]] static bool filter(const Cursor& cursor, const Entity entity, const TableRow table_row) noexcept requires FILTERS_ROWS {
+			return [&]<size_t ... I>(std::index_sequence<I...>) {
+				return (QueryFetch<Fs>::filter(std::get<I>(cursor), entity, table_row) || ...);
+			}(std::index_sequence_for<Fs...>{});
+		}
+	};
+
+	//shared by Added and Changed, IsNewer picks the tick to compare
+	template<Component T, bool (ComponentTicks::*IsNewer)(Tick, Tick) const noexcept>
+	struct TickFilterFetch {
+		static constexpr bool IS_DENSE = get_storage_type<T>() == StorageType::Table;
+		static constexpr bool READ_ONLY = true;
+		static constexpr bool MATCHED_BY_MASK = true;
+		static constexpr bool FILTERS_ROWS = true;
+
+		using State = ComponentId;
+		//null inside Or for archetypes without the component
+		using Cursor = ComponentCursor<const T>;
+		using Item = std::tuple<>;
+		using Slice = std::tuple<>;
+
+		[[nodiscard]] static State init_state(ComponentManager& component_manager) {
+			return component_manager.register_component<T>();
+		}
+
+		[[nodiscard]] static std::optional<ComponentId> required_component(const State& state) noexcept { return state; }
+		[[nodiscard]] static std::optional<ComponentId> excluded_component(const State&) noexcept { return std::nullopt; }
+
+		[[nodiscard]] static bool matches(const State& state, const Archetype& archetype) noexcept {
+			return archetype.has_component(state);
+		}
+
+		//reads the change ticks of the component
+		static void add_access(const State& state, ComponentAccess& access) {
+			access.add_read(state);
+		}
+
+		[[nodiscard]] static Cursor cursor(const State& state, Table& table, Storage& storage, const RunTicks ticks) noexcept {
+			return Cursor::make(state, table, storage, ticks);
+		}
+
+		[[nodiscard]] static Item fetch(const Cursor, const Entity, const TableRow) noexcept { return {}; }
+		[[nodiscard]] static Slice slice(const Cursor, const size_t, const size_t) noexcept { return {}; }
+
+		//the newest ticks of the whole column or sparse set, false lets the query skip all of its entities
+		[[nodiscard]] static bool may_pass(const Cursor cursor) noexcept {
+			if (!cursor.store) {
+				return false;
+			}
+			return is_newer(ComponentTicks{ cursor.store->added_tick(), cursor.store->changed_tick() }, cursor.ticks);
+		}
+
+		[[nodiscard]] static bool filter(const Cursor cursor, const Entity entity, const TableRow table_row) noexcept {
+			if (!cursor.store) {
+				return false;
+			}
+
+			if constexpr (IS_DENSE) {
+				return is_newer(cursor.store->ticks(table_row.to_index()), cursor.ticks);
+			} else {
+				return cursor.store->get_ticks(entity).transform([&](const ComponentTicks ticks) { return is_newer(ticks, cursor.ticks); }).value_or(false);
+			}
+		}
+
+	private:
+		[[nodiscard]] static bool is_newer(const ComponentTicks ticks, const RunTicks run) noexcept {
+			return (ticks.*IsNewer)(run.last_run, run.this_run);
+		}
+	};
+
+	template<Component T>
+	struct QueryFetch<Added<T>> : TickFilterFetch<T, &ComponentTicks::is_added> {};
+
+	template<Component T>
+	struct QueryFetch<Changed<T>> : TickFilterFetch<T, &ComponentTicks::is_changed> {};
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Utils/TypeInfo.h"
+
+/*
+	Singleton values of a world, e.g. time, configuration or event channels.
+
+	Resources are stored in a dense array indexed by utils::TypeIndex, so a lookup is one bounds check
+	and one comparison of the type hash stored next to the value, nothing is hashed at runtime.
+	TypeIndex is counted per translation unit, a type can get different indices in different ones,
+	so a resource is stored in the slot of the index it had in the translation unit that inserted it,
+	or at the end if that slot is taken. A TypeInfoMap from every resource to its slot is only searched
+	when the slot of the index doesn't hold the requested type.
+ */
+namespace glaze::ecs {
+	struct Resources {
+		Resources() = default;
+
+		Resources(const Resources&) = delete;
+		Resources& operator=(const Resources&) = delete;
+
+		Resources(Resources&&) noexcept = default;
+		Resources& operator=(Resources&&) noexcept = default;
+
+		//constructs the resource from args, replacing the one there is
+		template<typename R, typename ... Args> requires std::constructible_from<R, Args&&...>
+		R& insert(Args&& ... args) {
+			static_assert(std::is_same_v<R, std::remove_cvref_t<R>>, "Resources are stored by value");
+			auto* const resource = new R(std::forward<Args>(args)...);
+			Slot slot{ std::unique_ptr<void, DestroyFn>(resource, &destroy<R>), utils::TypeHash<R>::value };
+
+			if (auto* const existing = find<R>()) {
+				*existing = std::move(slot);
+				return *resource;
+			}
+
+			size_t index = utils::TypeIndex<R>::value;
+			if (index >= m_slots.size()) {
+				m_slots.resize(index + 1);
+			}
+			if (m_slots[index].data) {
+				index = m_slots.size();
+				m_slots.emplace_back();
+			}
+			m_slots[index] = std::move(slot);
+			m_indices.emplace(utils::TypeInfo::of<R>(), index);
+			++m_size;
+			return *resource;
+		}
+
+		//null if there is no such resource
+		template<typename R>
+		[[nodiscard]] auto* get(this auto& self) noexcept {
+			using Resource = std::conditional_t<std::is_const_v<std::remove_reference_t<decltype(self)>>, const R, R>;
+			const auto* const slot = self.template find<R>();
+			return slot ? static_cast<Resource*>(slot->data.get()) : nullptr;
+		}
+
+		template<typename R>
+		[[nodiscard]] bool contains() const noexcept { return find<R>() != nullptr; }
+
+		//false if there is no such resource
+		template<typename R>
+		bool remove() noexcept {
+			auto* const slot = find<R>();
+			if (!slot) {
+				return false;
+			}
+
+			*slot = Slot{};
+			m_indices.erase(utils::TypeInfo::of<R>());
+			--m_size;
+			return true;
+		}
+
+		void clear() noexcept {
+			m_slots.clear();
+			m_indices.clear();
+			m_size = 0;
+		}
+
+		[[nodiscard]] size_t size() const noexcept { return m_size; }
+		[[nodiscard]] bool empty() const noexcept { return m_size == 0; }
+
+	private:
+		using DestroyFn = void(*)(void* resource) noexcept;
+
+		struct Slot {
+			std::unique_ptr<void, DestroyFn> data{ nullptr, nullptr };
+			//TypeHash of the resource, tells apart types which got the same TypeIndex in different translation units
+			uint64_t hash = 0;
+		};
+
+		template<typename R>
+		static void destroy(void* const resource) noexcept {
+			delete static_cast<R*>(resource);
+		}
+
+		template<typename R>
+		[[nodiscard]] auto* find(this auto& self) noexcept {
+			using S = std::conditional_t<std::is_const_v<std::remove_reference_t<decltype(self)>>, const Slot, Slot>;
+			constexpr size_t index = utils::TypeIndex<R>::value;
+			if (index < self.m_slots.size() && self.m_slots[index].data && self.m_slots[index].hash == utils::TypeHash<R>::value) {
+				return static_cast<S*>(&self.m_slots[index]);
+			}
+			if (self.m_size == 0) {
+				return static_cast<S*>(nullptr);
+			}
+
+			//inserted from a translation unit where R has another index
+			const auto it = self.m_indices.find(utils::TypeInfo::of<R>());
+			return it == self.m_indices.end() ? static_cast<S*>(nullptr) : static_cast<S*>(&self.m_slots[it->second]);
+		}
+
+		//indexed by the TypeIndex of the resource unless the slot was taken
+		std::vector<Slot> m_slots;
+		//slot of every resource
+		utils::TypeInfoMap<size_t> m_indices;
+		size_t m_size = 0;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,215 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <span>
+#include <tuple>
+#include <vector>
+
+#include "ECS/Query/Query.h"
+#include "Utils/ThreadPool.h"
+
+/*
+	Schedule runs systems, which are functions declaring the queries they iterate.
+
+	Every system's read and write sets are derived from the terms of its queries.
+	A system depends on every system added before it that writes what it reads or reads what it writes,
+	so running the graph gives the same result as running the systems one after another in the order they were added.
+	Systems that touch disjoint components don't depend on each other and run at the same time on a thread pool,
+	a system is submitted to the pool as soon as the last system it depends on finished.
+
+	Systems which create or destroy entities or add and remove components have to be exclusive,
+	the others should record such changes into Commands that an exclusive system applies.
+ */
+namespace glaze::ecs {
+	template<typename Q>
+	concept SystemQuery = requires(const Q& query) {
+		{ query.access() } -> std::same_as<ComponentAccess>;
+	} && std::constructible_from<Q, World&>;
+
+	struct Schedule {
+		//func is invoked with (World&, Qs&...), the queries are created once and kept between runs
+		//func must only access the world through its queries, other systems may be running at the same time
+		template<SystemQuery ... Qs, typename F> requires std::invocable<F&, World&, Qs&...>
+		SystemId add_system(World& world, F&& func) {
+			using State = SystemState<std::decay_t<F>, Qs...>;
+			auto state = std::make_unique<State>(std::forward<F>(func), std::tuple<Qs...>{ Qs{ world }... });
+
+			ComponentAccess access;
+			std::apply([&](const Qs&... queries) {
+				(access.extend(queries.access()), ...);
+			}, state->queries);
+
+			return add(&State::run, &State::check_ticks, &State::destroy, state.release(), std::move(access));
+		}
+
+		//func is invoked with (World&) while no other system runs, so it may change the world structure
+		template<typename F> requires std::invocable<F&, World&>
+		SystemId add_exclusive_system(F&& func) {
+			using State = SystemState<std::decay_t<F>>;
+			auto state = std::make_unique<State>(std::forward<F>(func), std::tuple<>{});
+
+			ComponentAccess access;
+			access.set_exclusive();
+			return add(&State::run, &State::check_ticks, &State::destroy, state.release(), std::move(access));
+		}
+
+		//runs the systems on the calling thread in the order they were added
+		void run(World& world) {
+			check_change_ticks(world);
+			for (auto& system : m_systems) {
+				system.run(system.state.get(), world);
+			}
+		}
+
+		//runs the systems on the pool and blocks until all of them finished, the calling thread helps executing them
+		//systems are invoked from a noexcept task, so an exception escaping one terminates
+		void run(World& world, utils::ThreadPool& pool) {
+			if (pool.worker_count() == 0 || m_systems.size() < 2) {
+				run(world);
+				return;
+			}
+
+			build_graph();
+			check_change_ticks(world);
+
+			RunContext context{ this, &world, &pool, std::make_unique<std::atomic<uint32_t>[]>(m_systems.size()), m_systems.size() };
+			for (size_t i = 0; i < m_systems.size(); ++i) {
+				context.waiting[i].store(m_systems[i].dependency_count, std::memory_order_relaxed);
+			}
+
+			for (size_t i = 0; i < m_systems.size(); ++i) {
+				if (m_systems[i].dependency_count == 0) {
+					pool.submit({ &run_task, &context, i, i + 1 });
+				}
+			}
+
+			pool.help_until([&] { return context.remaining.load(std::memory_order_acquire) == 0; });
+		}
+
+		//systems added before this one that have to finish before it starts
+		[[nodiscard]] std::vector<SystemId> dependencies(const SystemId system_id) {
+			build_graph();
+
+			std::vector<SystemId> dependencies;
+			for (size_t i = 0; i < system_id.to_index(); ++i) {
+				if (std::ranges::contains(m_systems[i].dependents, system_id)) {
+					dependencies.push_back(SystemId::from_index(i));
+				}
+			}
+			return dependencies;
+		}
+
+		[[nodiscard]] const ComponentAccess& access(const SystemId system_id) const noexcept { return m_systems[system_id.to_index()].access; }
+		[[nodiscard]] size_t size() const noexcept { return m_systems.size(); }
+		[[nodiscard]] bool empty() const noexcept { return m_systems.empty(); }
+
+	private:
+		template<typename F, typename ... Qs>
+		struct SystemState {
+			F func;
+			std::tuple<Qs...> queries;
+
+			static void run(void* const ptr, World& world) {
+				auto& state = *static_cast<SystemState*>(ptr);
+				std::apply([&](Qs&... qs) { state.func(world, qs...); }, state.queries);
+			}
+
+			static void check_ticks(void* const ptr, const Tick this_run) noexcept {
+				auto& state = *static_cast<SystemState*>(ptr);
+				std::apply([&](Qs&... qs) {
+					([&] {
+						if constexpr (requires { qs.check_change_ticks(this_run); }) {
+							qs.check_change_ticks(this_run);
+						}
+					}(), ...);
+				}, state.queries);
+			}
+
+			static void destroy(void* const ptr) noexcept {
+				delete static_cast<SystemState*>(ptr);
+			}
+		};
+
+		using RunFn = void(*)(void* state, World& world);
+		using CheckTicksFn = void(*)(void* state, Tick this_run) noexcept;
+		using DestroyFn = void(*)(void* state) noexcept;
+
+		struct System {
+			std::unique_ptr<void, DestroyFn> state;
+			RunFn run;
+			CheckTicksFn check_ticks;
+			ComponentAccess access;
+
+			std::vector<SystemId> dependents;
+			uint32_t dependency_count = 0;
+		};
+
+		struct RunContext {
+			Schedule* schedule;
+			World* world;
+			utils::ThreadPool* pool;
+			//dependencies of every system that haven't finished yet
+			std::unique_ptr<std::atomic<uint32_t>[]> waiting;
+			std::atomic<size_t> remaining;
+		};
+
+		SystemId add(const RunFn run, const CheckTicksFn check_ticks, const DestroyFn destroy, void* const state, ComponentAccess access) {
+			m_systems.push_back(System{ std::unique_ptr<void, DestroyFn>(state, destroy), run, check_ticks, std::move(access) });
+			m_graph_dirty = true;
+			return SystemId::from_index(m_systems.size() - 1);
+		}
+
+		//clamps the last runs of the systems' queries whenever the world clamped its ticks
+		void check_change_ticks(World& world) {
+			if (!world.check_change_ticks()) {
+				return;
+			}
+			for (auto& system : m_systems) {
+				system.check_ticks(system.state.get(), world.change_tick());
+			}
+		}
+
+		//edges only point from earlier to later systems, so the insertion order is a topological order
+		void build_graph() {
+			if (!m_graph_dirty) {
+				return;
+			}
+
+			for (auto& system : m_systems) {
+				system.dependents.clear();
+				system.dependency_count = 0;
+			}
+
+			for (size_t i = 0; i < m_systems.size(); ++i) {
+				for (size_t j = 0; j < i; ++j) {
+					if (!m_systems[j].access.is_compatible(m_systems[i].access)) {
+						m_systems[j].dependents.push_back(SystemId::from_index(i));
+						++m_systems[i].dependency_count;
+					}
+				}
+			}
+
+			m_graph_dirty = false;
+		}
+
+		//runs system begin and submits the dependents it was the last dependency of
+		static void run_task(void* const ptr, const size_t begin, size_t) noexcept {
+			auto& context = *static_cast<RunContext*>(ptr);
+			auto& system = context.schedule->m_systems[begin];
+			system.run(system.state.get(), *context.world);
+
+			for (const auto dependent : system.dependents) {
+				const auto index = dependent.to_index();
+				if (context.waiting[index].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+					context.pool->submit({ &run_task, &context, index, index + 1 });
+				}
+			}
+
+			context.remaining.fetch_sub(1, std::memory_order_acq_rel);
+		}
+
+		std::vector<System> m_systems;
+		bool m_graph_dirty = false;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,433 @@
+#pragma once
+
+#include "Snapshot.h"
+
+/*
+	Deltas between two states of a world.
+
+	A DeltaRecorder remembers the version and archetype of every entity slot at its baseline.
+	Writing a delta compares the world against it: entities that were spawned, despawned or moved to another archetype
+	are written whole and grouped by archetype, of the other entities only the component rows changed since the baseline are written.
+	Changed rows are found through the change watermarks of columns and sparse sets first and their per row ticks after,
+	so apart from one pass over the entity slots the cost is proportional to what changed.
+	The recorder's baseline moves to the written state.
+
+	apply_delta brings a world in the baseline state, e.g. restored from a snapshot taken along with the baseline
+	or kept up to date with every earlier delta, to the state the delta was written at.
+	Like snapshots, deltas only store trivially copyable components.
+ */
+namespace glaze::ecs {
+	static constexpr std::array<char, 8> DELTA_MAGIC{ 'G', 'L', 'Z', 'D', 'E', 'L', 'T', 'A' };
+	static constexpr uint32_t DELTA_VERSION = 2;
+
+	struct DeltaHeader {
+		std::array<char, 8> magic = DELTA_MAGIC;
+		uint32_t version = DELTA_VERSION;
+		uint32_t component_count = 0;
+		uint64_t slot_count = 0;
+		uint64_t changed_slot_count = 0;
+		uint64_t free_count = 0;
+		uint64_t despawn_count = 0;
+		uint32_t group_count = 0;
+		uint32_t change_count = 0;
+	};
+
+	namespace details {
+		//entities placed into one archetype
+		struct DeltaGroup {
+			uint32_t table_component_count;
+			uint32_t sparse_component_count;
+			uint64_t entity_count;
+		};
+
+		//changed values of one component
+		struct DeltaChange {
+			uint32_t component_index;
+			uint32_t reserved;
+			uint64_t count;
+		};
+	}
+
+	struct DeltaRecorder {
+		//the current state of the world becomes the baseline
+		explicit DeltaRecorder(World& world) {
+			rebase(world);
+		}
+
+		//changes of the world since the baseline, the written state becomes the new baseline
+		//panics if a component that has to be written isn't trivially copyable
+		[[nodiscard]] std::vector<std::byte> write(World& world) {
+			using namespace details;
+
+			const auto& entity_manager = world.entity_manager();
+			const auto& component_manager = world.component_manager();
+			const auto& archetype_manager = world.archetype_manager();
+			const auto& storage = world.storage();
+			assert(!entity_manager.needs_flush() && "Reserved entities have to be flushed first");
+
+			std::vector<SlotState> current;
+			slot_states(entity_manager, current);
+			//writes made from now on are newer than this_run and go into the next delta
+			const Tick this_run = world.increment_change_tick();
+
+			SnapshotWriter writer;
+			DeltaHeader header;
+			writer.write(header);
+
+			header.component_count = static_cast<uint32_t>(component_manager.size());
+			write_components(writer, component_manager);
+
+			//spawned, despawned and moved entities, moved ones are despawned and placed again
+			std::vector<bool> structural(current.size());
+			std::vector<EntityIndex> changed_slots;
+			std::vector<EntityVersion> changed_versions;
+			std::vector<Entity> despawned;
+			std::vector<std::vector<Entity>> groups(archetype_manager.size());
+			for (size_t i = 0; i < current.size(); ++i) {
+				const auto& now = current[i];
+				const auto before = i < m_slots.size() ? m_slots[i] : SlotState{};
+				if (now.version == before.version && now.archetype_id == before.archetype_id) {
+					continue;
+				}
+
+				const auto index = EntityIndex::from_index(i);
+				structural[i] = true;
+				changed_slots.push_back(index);
+				changed_versions.push_back(now.version);
+				if (before.archetype_id.valid()) {
+					despawned.emplace_back(index, before.version);
+				}
+				if (now.archetype_id.valid()) {
+					groups[now.archetype_id.to_index()].emplace_back(index, now.version);
+				}
+			}
+
+			const auto free = entity_manager.free_indices();
+			header.slot_count = current.size();
+			header.changed_slot_count = changed_slots.size();
+			header.free_count = free.size();
+			header.despawn_count = despawned.size();
+			writer.write_bytes(changed_slots.data(), changed_slots.size() * sizeof(EntityIndex));
+			writer.align();
+			writer.write_bytes(changed_versions.data(), changed_versions.size() * sizeof(EntityVersion));
+			writer.align();
+			writer.write_bytes(free.data(), free.size_bytes());
+			writer.align();
+			writer.write_bytes(despawned.data(), despawned.size() * sizeof(Entity));
+			writer.align();
+
+			for (const auto& archetype : archetype_manager.archetypes()) {
+				const auto& entities = groups[archetype.id().to_index()];
+				if (entities.empty()) {
+					continue;
+				}
+				++header.group_count;
+
+				const auto table_components = archetype.table_components() | std::ranges::to<std::vector>();
+				const auto sparse_components = archetype.sparse_components() | std::ranges::to<std::vector>();
+				writer.write(DeltaGroup{
+					static_cast<uint32_t>(table_components.size()),
+					static_cast<uint32_t>(sparse_components.size()),
+					entities.size()
+				});
+				write_component_ids(writer, table_components);
+				write_component_ids(writer, sparse_components);
+				writer.align();
+				writer.write_bytes(entities.data(), entities.size() * sizeof(Entity));
+				writer.align();
+
+				const auto& table = storage[archetype.table_id()];
+				for (const auto component_id : table_components) {
+					const auto& meta = component_manager[component_id];
+					check_trivially_copyable(meta);
+					const auto& data = table[component_id].data();
+					for (const auto entity : entities) {
+						if (!data.zst()) {
+							writer.write_bytes(data.get(entity_manager.slots()[entity.index().to_index()].location.table_row.to_index()), meta.layout().size());
+						}
+					}
+					writer.align();
+				}
+				for (const auto component_id : sparse_components) {
+					const auto& meta = component_manager[component_id];
+					check_trivially_copyable(meta);
+					const auto& sparse_set = storage[component_id];
+					for (const auto entity : entities) {
+						if (meta.layout().size() != 0) {
+							writer.write_bytes(*sparse_set.get_untyped(entity), meta.layout().size());
+						}
+					}
+					writer.align();
+				}
+			}
+
+			//rows of entities that stayed in their archetype, written into one list per component
+			std::vector<ChangeList> changes(component_manager.size());
+			const auto changed = [&](const ComponentTicks ticks, const EntityIndex index) {
+				return ticks.is_changed(m_tick, this_run) && !structural[index.to_index()];
+			};
+
+			for (const auto& table : storage.table_manager.tables()) {
+				if (table.entity_count() == 0) {
+					continue;
+				}
+				for (const auto component_id : table.components()) {
+					const auto& column = table[component_id];
+					if (!column.changed_tick().is_newer_than(m_tick, this_run)) {
+						continue;
+					}
+
+					auto& list = changes[component_id.to_index()];
+					for (const auto rows : table.chunks()) {
+						const auto entities = table.entities(rows);
+						for (size_t i = 0; i < rows.length; ++i) {
+							if (changed(column.ticks(rows.offset + i), entities[i].index())) {
+								list.add(entities[i], column.data(), rows.offset + i);
+							}
+						}
+					}
+				}
+			}
+
+			for (const auto& [component_id, sparse_set] : storage.sparse_sets.iter()) {
+				if (sparse_set.empty() || !sparse_set.changed_tick().is_newer_than(m_tick, this_run)) {
+					continue;
+				}
+
+				auto& list = changes[component_id.to_index()];
+				const auto ticks = sparse_set.ticks();
+				const auto indices = sparse_set.entity_indices();
+				for (size_t row = 0; row < indices.size(); ++row) {
+					if (changed(ticks[row], indices[row])) {
+						list.add(Entity{ indices[row], current[indices[row].to_index()].version }, sparse_set.data(), row);
+					}
+				}
+			}
+
+			for (const auto& meta : component_manager.components()) {
+				const auto& list = changes[meta.id().to_index()];
+				if (list.entities.empty()) {
+					continue;
+				}
+				check_trivially_copyable(meta);
+				++header.change_count;
+
+				writer.write(DeltaChange{ component_index(meta.id()), 0, list.entities.size() });
+				writer.write_bytes(list.entities.data(), list.entities.size() * sizeof(Entity));
+				writer.align();
+				writer.write_bytes(list.bytes.data(), list.bytes.size());
+				writer.align();
+			}
+
+			m_slots = std::move(current);
+			m_tick = this_run;
+
+			writer.patch(0, header);
+			return writer.take();
+		}
+
+		//makes the current state of the world the baseline without writing a delta
+		void rebase(World& world) {
+			assert(!world.entity_manager().needs_flush() && "Reserved entities have to be flushed first");
+			slot_states(world.entity_manager(), m_slots);
+			m_tick = world.increment_change_tick();
+		}
+
+		//clamps the baseline tick after World::check_change_ticks did a pass, see Tick::clamp
+		void check_change_ticks(const Tick this_run) noexcept {
+			m_tick.clamp(this_run);
+		}
+
+	private:
+		//archetype is null for slots without a live entity
+		struct SlotState {
+			EntityVersion version = FIRST_ENTITY_VERSION;
+			ArchetypeId archetype_id = utils::null_id;
+		};
+
+		struct ChangeList {
+			std::vector<Entity> entities;
+			std::vector<std::byte> bytes;
+
+			void add(const Entity entity, const TypeErasedArray& data, const size_t row) {
+				entities.push_back(entity);
+				if (!data.zst()) {
+					const auto* const value = static_cast<const std::byte*>(data.get(row));
+					bytes.insert(bytes.end(), value, value + data.layout().size());
+				}
+			}
+		};
+
+		static void slot_states(const EntityManager& entity_manager, std::vector<SlotState>& states) {
+			const auto slots = entity_manager.slots();
+			std::vector<bool> free(slots.size());
+			for (const auto index : entity_manager.free_indices()) {
+				free[index.to_index()] = true;
+			}
+
+			states.resize(slots.size());
+			for (size_t i = 0; i < slots.size(); ++i) {
+				states[i] = SlotState{ slots[i].version, free[i] ? ArchetypeId{ utils::null_id } : slots[i].location.archetype_id };
+			}
+		}
+
+		std::vector<SlotState> m_slots;
+		Tick m_tick;
+	};
+
+	//applies a delta written by a DeltaRecorder to a world in the recorder's baseline state
+	//the world has to know every component the delta stores, see read_snapshot
+	//entities the delta despawns are destroyed with World::destroy_entities, moved ones keep their place in the hierarchy
+	//false if the delta is malformed or the world isn't in the baseline state, the world is left partially updated then
+	[[nodiscard]] inline bool apply_delta(World& world, const std::span<const std::byte> bytes) {
+		using namespace details;
+
+		auto& entity_manager = world.entity_manager();
+		auto& component_manager = world.component_manager();
+		auto& archetype_manager = world.archetype_manager();
+		auto& storage = world.storage();
+
+		SnapshotReader reader(bytes);
+		const auto header = reader.read<DeltaHeader>();
+		if (!reader.ok() || header.magic != DELTA_MAGIC || header.version != DELTA_VERSION) {
+			return false;
+		}
+
+		std::vector<ComponentId> components;
+		if (!read_components(reader, header.component_count, world, components)) {
+			return false;
+		}
+
+		const auto changed_slots = reader.read_span<EntityIndex>(header.changed_slot_count);
+		reader.align();
+		const auto changed_versions = reader.read_span<EntityVersion>(header.changed_slot_count);
+		reader.align();
+		const auto free = reader.read_span<EntityIndex>(header.free_count);
+		reader.align();
+		const auto despawned = reader.read_span<Entity>(header.despawn_count);
+		reader.align();
+		if (!reader.ok() || header.slot_count < entity_manager.max_size()) {
+			return false;
+		}
+		const auto in_slots = [&](const EntityIndex index) { return index.to_index() < header.slot_count; };
+		if (!std::ranges::all_of(changed_slots, in_slots) || !std::ranges::all_of(free, in_slots) || !std::ranges::is_sorted(changed_slots)) {
+			return false;
+		}
+
+		//entities that keep their version only moved to another archetype, they're taken out and placed again with their group
+		//the moves the writer's world made because of destroyed entities, e.g. children losing their parent, are in the delta as well
+		std::vector<Entity> destroyed;
+		std::vector<Entity> moved;
+		for (const auto entity : despawned) {
+			const auto slot = std::ranges::lower_bound(changed_slots, entity.index());
+			const bool same_version = slot != changed_slots.end() && *slot == entity.index()
+				&& changed_versions[static_cast<size_t>(slot - changed_slots.begin())] == entity.version();
+			(same_version ? moved : destroyed).push_back(entity);
+		}
+
+		if (world.destroy_entities(destroyed) != destroyed.size() || world.remove_entities(moved, false).size() != moved.size()) {
+			return false;
+		}
+		entity_manager.patch(header.slot_count, changed_slots, changed_versions, free);
+
+		const Tick tick = world.change_tick();
+		std::vector<ComponentId> table_components;
+		std::vector<ComponentId> sparse_components;
+		std::vector<EntityIndex> indices;
+
+		for (uint32_t i = 0; i < header.group_count; ++i) {
+			const auto group = reader.read<DeltaGroup>();
+			if (!read_component_ids(reader, group.table_component_count, components, table_components)
+				|| !read_component_ids(reader, group.sparse_component_count, components, sparse_components)) {
+				return false;
+			}
+
+			const auto entities = reader.read_span<Entity>(group.entity_count);
+			reader.align();
+			if (!reader.ok() || !std::ranges::all_of(entities, [&](const Entity entity) { return entity_manager.is_valid(entity); })) {
+				return false;
+			}
+
+			const auto archetype_id = archetype_manager.try_emplace(sorted(table_components), sorted(sparse_components), component_manager, storage.table_manager);
+			auto& archetype = archetype_manager[archetype_id];
+			auto& table = storage[archetype.table_id()];
+
+			table.reserve(entities.size());
+			const auto first_row = table.append_entities(entities).to_index();
+			for (const auto component_id : table_components) {
+				auto& column = table[component_id];
+				const auto* const data = reader.read_bytes(entities.size() * column.data().layout().size());
+				reader.align();
+				if (!reader.ok()) {
+					return false;
+				}
+				column.append_bytes(data, entities.size(), tick);
+			}
+
+			indices.clear();
+			for (const auto entity : entities) {
+				indices.push_back(entity.index());
+			}
+			for (const auto component_id : sparse_components) {
+				const auto* const data = reader.read_bytes(entities.size() * component_manager[component_id].layout().size());
+				reader.align();
+				if (!reader.ok()) {
+					return false;
+				}
+				storage[component_id].append_bytes(indices, data, tick);
+			}
+
+			archetype.reserve(entities.size());
+			for (size_t row = 0; row < entities.size(); ++row) {
+				entity_manager.set_location(entities[row], archetype.add_entity(entities[row], TableRow::from_index(first_row + row)));
+			}
+		}
+
+		for (uint32_t i = 0; i < header.change_count; ++i) {
+			const auto change = reader.read<DeltaChange>();
+			const auto entities = reader.read_span<Entity>(change.count);
+			reader.align();
+			if (!reader.ok() || change.component_index >= components.size() || !components[change.component_index].valid()) {
+				return false;
+			}
+
+			const auto component_id = components[change.component_index];
+			const auto& meta = component_manager[component_id];
+			const size_t size = meta.layout().size();
+			const auto* data = reader.read_bytes(entities.size() * size);
+			reader.align();
+			if (!reader.ok()) {
+				return false;
+			}
+
+			for (const auto entity : entities) {
+				const auto location = entity_manager.get_location(entity);
+				if (!location || !archetype_manager[location->archetype_id].has_component(component_id)) {
+					return false;
+				}
+
+				if (meta.storage_type() == StorageType::Table) {
+					auto& column = storage[location->table_id][component_id];
+					const auto row = location->table_row.to_index();
+					if (size != 0) {
+						std::memcpy(column.data().get(row), data, size);
+					}
+					column.mark_changed(row, tick);
+				} else {
+					auto& sparse_set = storage[component_id];
+					if (size != 0) {
+						std::memcpy(*sparse_set.get_untyped(entity), data, size);
+					}
+					sparse_set.mark_changed(entity, tick);
+				}
+				data += size;
+			}
+		}
+
+		if (!reader.ok() || !reader.at_end()) {
+			return false;
+		}
+		world.rebuild_hierarchy();
+		return true;
+	}
+}
\ No newline at end of file
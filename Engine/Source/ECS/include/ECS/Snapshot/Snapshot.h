@@ -0,0 +1,534 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include "ECS/World.h"
+#include "Utils/MappedFile.h"
+
+/*
+	Binary snapshot of a whole world.
+
+	It holds the entity slots, every non empty table with its entity list and raw column bytes,
+	the signatures and entity lists of non empty archetypes and the dense arrays of sparse sets.
+	Components are identified by their type name and their size and alignment are checked on load,
+	ids of the world that wrote it don't have to match the world loading it.
+	Only trivially copyable components can be stored: a column is restored with one copy per chunk,
+	no element is constructed. Restored components count as added at the change tick of the loading world.
+	The hierarchy is rebuilt from the restored ChildOf components.
+
+	Snapshots are meant to be loaded by the same build on the same platform, there's no endianness conversion.
+ */
+namespace glaze::ecs {
+	static constexpr std::array<char, 8> SNAPSHOT_MAGIC{ 'G', 'L', 'Z', 'S', 'N', 'A', 'P', '\0' };
+	static constexpr uint32_t SNAPSHOT_VERSION = 2;
+
+	struct SnapshotHeader {
+		std::array<char, 8> magic = SNAPSHOT_MAGIC;
+		uint32_t version = SNAPSHOT_VERSION;
+		uint32_t component_count = 0;
+		uint64_t slot_count = 0;
+		uint64_t free_count = 0;
+		uint32_t table_count = 0;
+		uint32_t archetype_count = 0;
+		uint32_t sparse_set_count = 0;
+		uint32_t reserved = 0;
+	};
+
+	//appends values and raw bytes to a buffer, sections are aligned to SECTION_ALIGN so they can be read in place
+	struct SnapshotWriter {
+		static constexpr size_t SECTION_ALIGN = 8;
+
+		template<typename T> requires std::is_trivially_copyable_v<T>
+		void write(const T& value) {
+			write_bytes(std::addressof(value), sizeof(T));
+		}
+
+		void write_bytes(const void* const data, const size_t size) {
+			if (size == 0) {
+				return;
+			}
+			const auto* const first = static_cast<const std::byte*>(data);
+			m_bytes.insert(m_bytes.end(), first, first + size);
+		}
+
+		void align() {
+			m_bytes.resize((m_bytes.size() + SECTION_ALIGN - 1) & ~(SECTION_ALIGN - 1));
+		}
+
+		//overwrites a value written earlier at offset
+		template<typename T> requires std::is_trivially_copyable_v<T>
+		void patch(const size_t offset, const T& value) noexcept {
+			assert(offset + sizeof(T) <= m_bytes.size());
+			std::memcpy(m_bytes.data() + offset, std::addressof(value), sizeof(T));
+		}
+
+		[[nodiscard]] size_t offset() const noexcept { return m_bytes.size(); }
+		[[nodiscard]] std::span<const std::byte> bytes() const noexcept { return m_bytes; }
+		[[nodiscard]] std::vector<std::byte> take() noexcept { return std::move(m_bytes); }
+
+	private:
+		std::vector<std::byte> m_bytes;
+	};
+
+	//reads back what a SnapshotWriter wrote, reading past the end fails the reader instead of touching memory
+	struct SnapshotReader {
+		explicit SnapshotReader(const std::span<const std::byte> bytes) noexcept
+			: m_bytes(bytes) {
+		}
+
+		template<typename T> requires std::is_trivially_copyable_v<T>
+		[[nodiscard]] T read() noexcept {
+			T value{};
+			if (const std::byte* const data = read_bytes(sizeof(T))) {
+				std::memcpy(std::addressof(value), data, sizeof(T));
+			}
+			return value;
+		}
+
+		//null if there aren't enough bytes left
+		[[nodiscard]] const std::byte* read_bytes(const size_t size) noexcept {
+			if (!m_ok || size > m_bytes.size() - m_offset) {
+				m_ok = false;
+				return nullptr;
+			}
+			const std::byte* const data = m_bytes.data() + m_offset;
+			m_offset += size;
+			return data;
+		}
+
+		//count elements stored in place, the section has to be aligned for T
+		template<typename T> requires std::is_trivially_copyable_v<T>
+		[[nodiscard]] std::span<const T> read_span(const size_t count) noexcept {
+			if (count > (m_bytes.size() - m_offset) / std::max<size_t>(sizeof(T), 1)) {
+				m_ok = false;
+			}
+			const std::byte* const data = read_bytes(count * sizeof(T));
+			if (!data) {
+				return {};
+			}
+			assert(reinterpret_cast<uintptr_t>(data) % alignof(T) == 0 && "Section isn't aligned");
+			return { reinterpret_cast<const T*>(data), count };
+		}
+
+		void align() noexcept {
+			const size_t aligned = (m_offset + SnapshotWriter::SECTION_ALIGN - 1) & ~(SnapshotWriter::SECTION_ALIGN - 1);
+			m_offset = std::min(aligned, m_bytes.size());
+		}
+
+		[[nodiscard]] bool ok() const noexcept { return m_ok; }
+		[[nodiscard]] bool at_end() const noexcept { return m_offset == m_bytes.size(); }
+
+	private:
+		std::span<const std::byte> m_bytes;
+		size_t m_offset = 0;
+		bool m_ok = true;
+	};
+
+	namespace details {
+		struct SnapshotComponent {
+			uint32_t name_size;
+			uint32_t size;
+			uint32_t align;
+			uint32_t storage_type;
+			//EntityID of the target of a pair, NO_PAIR_TARGET for other components
+			uint64_t pair_target;
+		};
+
+		static constexpr uint64_t NO_PAIR_TARGET = std::numeric_limits<uint64_t>::max();
+
+		struct SnapshotTable {
+			uint32_t column_count;
+			uint32_t reserved;
+			uint64_t row_count;
+		};
+
+		struct SnapshotArchetype {
+			uint32_t table_index;
+			uint32_t table_component_count;
+			uint32_t sparse_component_count;
+			uint32_t reserved;
+			uint64_t entity_count;
+		};
+
+		struct SnapshotSparseSet {
+			uint32_t component_index;
+			uint32_t reserved;
+			uint64_t count;
+		};
+
+		static constexpr uint32_t NO_SNAPSHOT_TABLE = std::numeric_limits<uint32_t>::max();
+
+		[[nodiscard]] inline uint32_t component_index(const ComponentId id) noexcept {
+			return static_cast<uint32_t>(id.to_index());
+		}
+
+		inline void write_component_ids(SnapshotWriter& writer, const auto& ids) {
+			for (const auto id : ids) {
+				writer.write(component_index(id));
+			}
+		}
+
+		inline void check_trivially_copyable(const ComponentMeta& meta) noexcept {
+			if (!meta.type_ops().trivially_copyable) {
+				utils::panic("Snapshot: component {} isn't trivially copyable", meta.name());
+			}
+		}
+
+		//the writer's component indices mapped to ids of the loading world, in the order they were written
+		[[nodiscard]] inline bool read_component_ids(SnapshotReader& reader, const size_t count, const std::span<const ComponentId> components, std::vector<ComponentId>& out) {
+			const auto indices = reader.read_span<uint32_t>(count);
+			reader.align();
+			if (!reader.ok()) {
+				return false;
+			}
+
+			out.clear();
+			for (const auto index : indices) {
+				if (index >= components.size() || !components[index].valid()) {
+					return false;
+				}
+				out.push_back(components[index]);
+			}
+			return true;
+		}
+
+		//every registered component, stored data refers to them by their position
+		//released pairs have a null target and are written like their relation, no stored data refers to them
+		inline void write_components(SnapshotWriter& writer, const ComponentManager& component_manager) {
+			for (const auto& meta : component_manager.components()) {
+				writer.write(SnapshotComponent{
+					static_cast<uint32_t>(meta.name().size()),
+					static_cast<uint32_t>(meta.layout().size()),
+					static_cast<uint32_t>(meta.layout().align()),
+					static_cast<uint32_t>(meta.storage_type()),
+					meta.is_pair() ? meta.target().to_id().get() : NO_PAIR_TARGET
+				});
+				writer.write_bytes(meta.name().data(), meta.name().size());
+				writer.align();
+			}
+		}
+
+		//ids of the written components in the world, matched by name, null for components the world doesn't know
+		//pairs are matched by the name of their relation and registered with the same target, entities keep their ids
+		//false if a known component's layout or storage doesn't match or it can't be restored from bytes
+		[[nodiscard]] inline bool read_components(SnapshotReader& reader, const size_t count, World& world, std::vector<ComponentId>& components) {
+			auto& component_manager = world.component_manager();
+			components.clear();
+			components.reserve(count);
+			for (size_t i = 0; i < count; ++i) {
+				const auto component = reader.read<SnapshotComponent>();
+				const auto* const name_data = reader.read_bytes(component.name_size);
+				reader.align();
+				if (!reader.ok()) {
+					return false;
+				}
+
+				const std::string_view name{ reinterpret_cast<const char*>(name_data), component.name_size };
+				const auto it = std::ranges::find_if(component_manager.components(), [name](const ComponentMeta& meta) {
+					return !meta.is_pair() && meta.name() == name;
+				});
+				if (it == component_manager.components().end()) {
+					//components the world doesn't know are fine as long as no stored data refers to them
+					components.push_back(utils::null_id);
+					continue;
+				}
+				if (it->layout().size() != component.size || it->layout().align() != component.align
+					|| static_cast<uint32_t>(it->storage_type()) != component.storage_type || !it->type_ops().trivially_copyable) {
+					return false;
+				}
+
+				const auto id = component.pair_target == NO_PAIR_TARGET
+					? it->id()
+					: component_manager.register_pair(it->id(), Entity::from_id(EntityID{ component.pair_target }));
+				world.storage().ensure_component(component_manager[id]);
+				components.push_back(id);
+			}
+			return true;
+		}
+
+		[[nodiscard]] inline std::vector<ComponentId> sorted(std::vector<ComponentId> ids) {
+			std::ranges::sort(ids);
+			return ids;
+		}
+	}
+
+	//every entity and component of the world, reserved entities have to be flushed first
+	//panics if a component stored in the world isn't trivially copyable
+	[[nodiscard]] inline std::vector<std::byte> write_snapshot(const World& world) {
+		using namespace details;
+
+		const auto& entity_manager = world.entity_manager();
+		const auto& component_manager = world.component_manager();
+		const auto& storage = world.storage();
+		assert(!entity_manager.needs_flush() && "Reserved entities have to be flushed first");
+
+		SnapshotWriter writer;
+		SnapshotHeader header;
+		writer.write(header);
+
+		header.component_count = static_cast<uint32_t>(component_manager.size());
+		write_components(writer, component_manager);
+
+		const auto slots = entity_manager.slots();
+		const auto free = entity_manager.free_indices();
+		header.slot_count = slots.size();
+		header.free_count = free.size();
+		for (const auto& slot : slots) {
+			writer.write(slot.version);
+		}
+		writer.align();
+		writer.write_bytes(free.data(), free.size_bytes());
+		writer.align();
+
+		//tables are written in id order skipping empty ones, archetypes refer to them by their position
+		std::vector<uint32_t> table_indices(storage.table_manager.size(), NO_SNAPSHOT_TABLE);
+		for (const auto& table : storage.table_manager.tables()) {
+			if (table.entity_count() == 0) {
+				continue;
+			}
+			table_indices[table.id().to_index()] = header.table_count++;
+
+			writer.write(SnapshotTable{ static_cast<uint32_t>(table.component_count()), 0, table.entity_count() });
+			write_component_ids(writer, table.components());
+			writer.align();
+
+			for (const auto rows : table.chunks()) {
+				writer.write_bytes(table.entities(rows).data(), rows.length * sizeof(Entity));
+			}
+			writer.align();
+
+			for (const auto component_id : table.components()) {
+				const auto& meta = component_manager[component_id];
+				check_trivially_copyable(meta);
+
+				const auto& column = table[component_id];
+				for (const auto rows : table.chunks()) {
+					if (!column.data().zst()) {
+						writer.write_bytes(column.data().get(rows.offset), rows.length * meta.layout().size());
+					}
+				}
+				writer.align();
+			}
+		}
+
+		for (const auto& archetype : world.archetype_manager().archetypes()) {
+			if (archetype.empty()) {
+				continue;
+			}
+			++header.archetype_count;
+
+			const auto table_components = archetype.table_components() | std::ranges::to<std::vector>();
+			const auto sparse_components = archetype.sparse_components() | std::ranges::to<std::vector>();
+			writer.write(SnapshotArchetype{
+				table_indices[archetype.table_id().to_index()],
+				static_cast<uint32_t>(table_components.size()),
+				static_cast<uint32_t>(sparse_components.size()),
+				0,
+				archetype.entity_count()
+			});
+			write_component_ids(writer, table_components);
+			write_component_ids(writer, sparse_components);
+			writer.align();
+
+			const auto entities = archetype.entities();
+			writer.write_bytes(entities.data(), entities.size_bytes());
+			writer.align();
+		}
+
+		for (const auto& [component_id, sparse_set] : storage.sparse_sets.iter()) {
+			if (sparse_set.empty()) {
+				continue;
+			}
+			++header.sparse_set_count;
+
+			const auto& meta = component_manager[component_id];
+			check_trivially_copyable(meta);
+
+			writer.write(SnapshotSparseSet{ component_index(component_id), 0, sparse_set.size() });
+			const auto entity_indices = sparse_set.entity_indices();
+			writer.write_bytes(entity_indices.data(), entity_indices.size_bytes());
+			writer.align();
+			if (!sparse_set.data().zst()) {
+				writer.write_bytes(sparse_set.data().get(0), sparse_set.size() * meta.layout().size());
+			}
+			writer.align();
+		}
+
+		writer.patch(0, header);
+		return writer.take();
+	}
+
+	//restores a snapshot into a world without entities, its components have to be registered already
+	//false if the snapshot is malformed or doesn't match the world's components, a truncated snapshot leaves the world partially restored
+	[[nodiscard]] inline bool read_snapshot(World& world, const std::span<const std::byte> bytes) {
+		using namespace details;
+
+		auto& entity_manager = world.entity_manager();
+		auto& component_manager = world.component_manager();
+		auto& archetype_manager = world.archetype_manager();
+		auto& storage = world.storage();
+		assert(entity_manager.max_size() == 0 && !entity_manager.needs_flush() && "Snapshots are only loaded into worlds without entities");
+
+		SnapshotReader reader(bytes);
+		const auto header = reader.read<SnapshotHeader>();
+		if (!reader.ok() || header.magic != SNAPSHOT_MAGIC || header.version != SNAPSHOT_VERSION) {
+			return false;
+		}
+
+		std::vector<ComponentId> components;
+		if (!read_components(reader, header.component_count, world, components)) {
+			return false;
+		}
+
+		const auto versions = reader.read_span<EntityVersion>(header.slot_count);
+		reader.align();
+		const auto free = reader.read_span<EntityIndex>(header.free_count);
+		reader.align();
+		const auto in_slots = [&](const EntityIndex index) { return index.to_index() < header.slot_count; };
+		if (!reader.ok() || !std::ranges::all_of(free, in_slots)) {
+			return false;
+		}
+		entity_manager.restore(versions, free);
+
+		const Tick tick = world.change_tick();
+		std::vector<ComponentId> table_components;
+		std::vector<ComponentId> sparse_components;
+
+		//tables are filled in the writer's order, so the table rows stored in archetypes stay valid
+		std::vector<TableId> tables;
+		tables.reserve(header.table_count);
+		for (uint32_t i = 0; i < header.table_count; ++i) {
+			const auto table_header = reader.read<SnapshotTable>();
+			if (!read_component_ids(reader, table_header.column_count, components, table_components)) {
+				return false;
+			}
+
+			const auto entities = reader.read_span<Entity>(table_header.row_count);
+			reader.align();
+			if (!reader.ok()) {
+				return false;
+			}
+
+			const auto table_id = storage.table_manager.try_emplace(sorted(table_components), component_manager);
+			auto& table = storage[table_id];
+			if (table.entity_count() != 0) {
+				return false;
+			}
+			tables.push_back(table_id);
+
+			table.reserve(entities.size());
+			table.append_entities(entities);
+
+			//columns are in the writer's id order, which doesn't have to be the order of this world's ids
+			for (const auto component_id : table_components) {
+				auto& column = table[component_id];
+				const auto* const data = reader.read_bytes(entities.size() * column.data().layout().size());
+				reader.align();
+				if (!reader.ok()) {
+					return false;
+				}
+				column.append_bytes(data, entities.size(), tick);
+			}
+		}
+
+		for (uint32_t i = 0; i < header.archetype_count; ++i) {
+			const auto archetype_header = reader.read<SnapshotArchetype>();
+			if (!read_component_ids(reader, archetype_header.table_component_count, components, table_components)
+				|| !read_component_ids(reader, archetype_header.sparse_component_count, components, sparse_components)) {
+				return false;
+			}
+
+			const auto entities = reader.read_span<ArchetypeEntity>(archetype_header.entity_count);
+			reader.align();
+			if (!reader.ok() || archetype_header.table_index >= tables.size()) {
+				return false;
+			}
+
+			const auto archetype_id = archetype_manager.try_emplace(sorted(table_components), sorted(sparse_components), component_manager, storage.table_manager);
+			auto& archetype = archetype_manager[archetype_id];
+			if (archetype.table_id() != tables[archetype_header.table_index]) {
+				return false;
+			}
+
+			//rows have to point into the restored table and every entity is placed once
+			const size_t row_count = storage[archetype.table_id()].entity_count();
+			archetype.reserve(entities.size());
+			for (const auto& [entity, table_row] : entities) {
+				if (!entity_manager.is_valid(entity) || entity_manager.get_location(entity) || table_row.to_index() >= row_count) {
+					return false;
+				}
+				entity_manager.set_location(entity, archetype.add_entity(entity, table_row));
+			}
+		}
+
+		//marks the entities of the sparse set being restored, so an index stored twice is caught
+		std::vector<bool> in_set(header.slot_count);
+		for (uint32_t i = 0; i < header.sparse_set_count; ++i) {
+			const auto sparse_header = reader.read<SnapshotSparseSet>();
+			const auto indices = reader.read_span<EntityIndex>(sparse_header.count);
+			reader.align();
+			if (!reader.ok() || sparse_header.component_index >= components.size() || !components[sparse_header.component_index].valid()) {
+				return false;
+			}
+
+			const auto component_id = components[sparse_header.component_index];
+			const auto& meta = component_manager[component_id];
+			if (meta.storage_type() != StorageType::SparseSet || !std::ranges::all_of(indices, in_slots)) {
+				return false;
+			}
+
+			//every index has to be an entity placed in an archetype above, that isn't in the set yet
+			auto& sparse_set = storage[component_id];
+			const auto placed_once = [&](const EntityIndex index) {
+				const auto entity = entity_manager.entity(index);
+				if (!entity || !entity_manager.get_location(*entity) || in_set[index.to_index()] || sparse_set.contains(*entity)) {
+					return false;
+				}
+				in_set[index.to_index()] = true;
+				return true;
+			};
+			const bool valid = std::ranges::all_of(indices, placed_once);
+			for (const auto index : indices) {
+				in_set[index.to_index()] = false;
+			}
+			if (!valid) {
+				return false;
+			}
+
+			const auto* const data = reader.read_bytes(indices.size() * meta.layout().size());
+			reader.align();
+			if (!reader.ok()) {
+				return false;
+			}
+			sparse_set.append_bytes(indices, data, tick);
+		}
+
+		if (!reader.ok() || !reader.at_end()) {
+			return false;
+		}
+		world.rebuild_hierarchy();
+		return true;
+	}
+
+	//writes the snapshot of the world to a file, false if it can't be written
+	[[nodiscard]] inline bool save_snapshot(const World& world, const std::filesystem::path& path) {
+		const auto bytes = write_snapshot(world);
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+		return static_cast<bool>(file);
+	}
+
+	//maps the file and restores it like read_snapshot, the columns are copied straight out of the mapping
+	[[nodiscard]] inline bool load_snapshot(World& world, const std::filesystem::path& path) {
+		const utils::MappedFile file(path);
+		return !file.empty() && read_snapshot(world, file.bytes());
+	}
+}
\ No newline at end of file
@@ -2,11 +2,16 @@
 
 #include "ECS/Storage/TypeErasedArray.h"
 #include "ECS/Component/ComponentMeta.h"
+#include "ECS/Component/ComponentTicks.h"
+#include "Utils/SwapRemove.h"
 
 namespace glaze::ecs {
 	struct ComponentSparseSet {
-		ComponentSparseSet(const ComponentMeta& component, const size_t capacity)
-			: m_components(component.layout(), component.type_ops(), capacity), m_entities(capacity) {
+		ComponentSparseSet(const ComponentMeta& component, const size_t capacity, const utils::Allocator allocator = {})
+			: m_components(component.layout(), component.type_ops(), capacity, 0, allocator),
+			  m_ticks(allocator),
+			  m_entities(capacity, allocator) {
+			m_ticks.reserve(capacity);
 		}
 
 		ComponentSparseSet(const ComponentSparseSet& component) = delete;
@@ -16,8 +21,8 @@ namespace glaze::ecs {
 		ComponentSparseSet& operator=(ComponentSparseSet&& component) = default;
 
 		template<Component T>
-		void insert(const Entity entity, T&& data) {
-			insert_untyped(entity, std::addressof(data));
+		void insert(const Entity entity, T&& data, const Tick tick) {
+			insert_untyped(entity, std::addressof(data), tick);
 		}
 
 		template<Component T>
@@ -51,18 +56,87 @@ namespace glaze::ecs {
 					m_entities[moved_entity] = table_row;
 				}
 
+				utils::swap_remove(m_ticks, dense_index);
 				return m_components.swap_remove<U>(dense_index);
 			});
 		}
 
-		void insert_untyped(const Entity entity, void* const data) {
+		//inserting marks the component as added, replacing it only as changed
+		void insert_untyped(const Entity entity, void* const data, const Tick tick) {
 			if (const auto dense_index_opt = m_entities.at(entity.index())) {
 				const auto dense_index = dense_index_opt.value().get();
 				m_components.move_replace(dense_index.to_index(), data);
+				m_ticks[dense_index.to_index()].changed = tick;
 			} else {
 				const auto table_row = TableRow::from_index(m_components.size());
 				m_components.move_emplace_back(data);
+				m_ticks.push_back(ComponentTicks{ tick, tick });
 				m_entities.insert(entity.index(), table_row);
+				m_added_tick.raise(tick);
+			}
+			m_changed_tick.raise(tick);
+		}
+
+		//appends components copied from the bytes at src for entities not in the set yet, only for trivially copyable components
+		void append_bytes(const std::span<const EntityIndex> indices, const std::byte* const src, const Tick tick) {
+			if (indices.empty()) {
+				return;
+			}
+
+			const size_t first = m_components.size();
+			m_components.append_bytes(src, indices.size());
+			m_ticks.resize(m_ticks.size() + indices.size(), ComponentTicks{ tick, tick });
+			m_entities.reserve(first + indices.size());
+			for (size_t i = 0; i < indices.size(); ++i) {
+				assert(!m_entities.contains(indices[i]) && "Entity already has the component");
+				m_entities.insert(indices[i], TableRow::from_index(first + i));
+			}
+			m_added_tick.raise(tick);
+			m_changed_tick.raise(tick);
+		}
+
+		//replaces the content with copies of other's, keeping the allocations
+		void copy_from(const ComponentSparseSet& other) {
+			m_components.copy_from(other.m_components);
+			m_ticks = other.m_ticks;
+			m_added_tick = other.m_added_tick;
+			m_changed_tick = other.m_changed_tick;
+			m_entities.copy_from(other.m_entities);
+		}
+
+		void clear() noexcept {
+			m_components.resize(0);
+			m_ticks.clear();
+			m_entities.clear();
+		}
+
+		//row of the entity in the dense component array, entity_indices()[row] is the entity again
+		[[nodiscard]] std::optional<TableRow> dense_row(const EntityIndex index) const noexcept {
+			return m_entities.at(index).transform([](const auto table_row_ref) { return table_row_ref.get(); });
+		}
+
+		template<Component T>
+		[[nodiscard]] T& get_row(const TableRow row) noexcept {
+			return *m_components.get<std::remove_cvref_t<T>>(row.to_index());
+		}
+
+		void mark_row_changed(const TableRow row, const Tick tick) noexcept {
+			m_ticks[row.to_index()].changed = tick;
+			m_changed_tick.raise(tick);
+		}
+
+		void prefetch(const EntityIndex index) const noexcept { m_entities.prefetch(index); }
+
+		[[nodiscard]] std::optional<ComponentTicks> get_ticks(const Entity entity) const noexcept {
+			return m_entities.at(entity.index()).transform([this](const auto dense_index_ref) {
+				return m_ticks[dense_index_ref.get().to_index()];
+			});
+		}
+
+		void mark_changed(const Entity entity, const Tick tick) noexcept {
+			if (const auto dense_index = m_entities.at(entity.index())) {
+				m_ticks[dense_index->get().to_index()].changed = tick;
+				m_changed_tick.raise(tick);
 			}
 		}
 
@@ -90,6 +164,7 @@ namespace glaze::ecs {
 			const bool is_last = dense_index == m_components.size() - 1;
 
 			m_components.swap_remove(dense_index);
+			utils::swap_remove(m_ticks, dense_index);
 
 			if (!is_last) {
 				const EntityIndex moved_entity = m_entities.indices()[dense_index];
@@ -97,13 +172,38 @@ namespace glaze::ecs {
 			}
 		}
 
+		void reserve(const size_t additional) {
+			m_components.reserve(m_components.size() + additional);
+			m_ticks.reserve(m_ticks.size() + additional);
+		}
+
+		//clamps the ticks of every component and the watermarks, see Tick::clamp
+		void check_ticks(const Tick this_run) noexcept {
+			for (auto& ticks : m_ticks) {
+				ticks.clamp(this_run);
+			}
+			m_added_tick.clamp(this_run);
+			m_changed_tick.clamp(this_run);
+		}
+
 		[[nodiscard]] size_t size() const noexcept { return m_components.size(); }
 		[[nodiscard]] size_t capacity() const noexcept { return m_components.capacity(); }
 		[[nodiscard]] bool empty() const noexcept { return m_components.empty(); }
 		[[nodiscard]] bool contains(const Entity entity) const noexcept { return m_entities.contains(entity.index()); }
+		[[nodiscard]] std::span<const ComponentTicks> ticks() const noexcept { return m_ticks; }
+		//dense component array, indexed like entity_indices()
+		[[nodiscard]] const TypeErasedArray& data() const noexcept { return m_components; }
+		[[nodiscard]] std::span<const EntityIndex> entity_indices() const noexcept { return m_entities.indices(); }
+		//newest added and changed tick of any entity in the set
+		[[nodiscard]] Tick added_tick() const noexcept { return m_added_tick.get(); }
+		[[nodiscard]] Tick changed_tick() const noexcept { return m_changed_tick.get(); }
 
 	private:
 		TypeErasedArray m_components;
+		//added and changed ticks, indexed like m_components
+		std::vector<ComponentTicks, utils::StdAllocator<ComponentTicks>> m_ticks;
+		TickWatermark m_added_tick;
+		TickWatermark m_changed_tick;
 		SparseSet<EntityIndex, TableRow> m_entities;
 	};
 }
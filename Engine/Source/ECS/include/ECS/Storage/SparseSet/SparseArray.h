@@ -7,21 +7,45 @@
 #include <memory>
 #include <cassert>
 #include <optional>
+#include <utility>
 
 #include "SparseIndex.h"
 
+#include "Utils/Allocator.h"
 #include "Utils/Optional.h"
+#include "Utils/Panic.h"
+#include "Utils/Prefetch.h"
 
 namespace glaze::ecs {
 	template<SparseIndex I, std::move_constructible V, size_t PAGE_SIZE = 4096> requires (PAGE_SIZE > 0)
 	struct SparseArray {
 		SparseArray() = default;
 
+		//pages are allocated through allocator
+		explicit SparseArray(const utils::Allocator allocator) noexcept
+			: m_allocator(allocator) {
+		}
+
+		~SparseArray() { clear(); }
+
 		SparseArray(const SparseArray&) = delete;
 		SparseArray& operator=(const SparseArray&) = delete;
 
-		SparseArray(SparseArray&&) noexcept = default;
-		SparseArray& operator=(SparseArray&&) noexcept = default;
+		SparseArray(SparseArray&& other) noexcept
+			: m_pages(std::exchange(other.m_pages, {})),
+			  m_live(std::exchange(other.m_live, 0)),
+			  m_allocator(other.m_allocator) {
+		}
+
+		SparseArray& operator=(SparseArray&& other) noexcept {
+			if (this != &other) {
+				clear();
+				m_pages = std::exchange(other.m_pages, {});
+				m_live = std::exchange(other.m_live, 0);
+				m_allocator = other.m_allocator;
+			}
+			return *this;
+		}
 
 		template<typename... Args> requires std::constructible_from<V, Args...>
 		V& emplace(const I index, Args&&... args) {
@@ -65,7 +89,7 @@ namespace glaze::ecs {
 			--m_live;
 
 			if (page->empty()) {
-				m_pages[pi].reset();
+				destroy_page(std::exchange(m_pages[pi], nullptr));
 				trim_trailing_empty_pages();
 			}
 
@@ -121,11 +145,42 @@ namespace glaze::ecs {
 			return page && page->contains(page_offset(pos));
 		}
 
+		//pulls the slot of index into the cache ahead of a contains/at, missing pages are skipped
+		void prefetch(const I index) const noexcept {
+			const size_t pos = index.to_index();
+			if (const Page* page = try_page(page_index(pos))) {
+				page->prefetch(page_offset(pos));
+			}
+		}
+
 		[[nodiscard]] bool empty() const noexcept { return m_live == 0; }
 		[[nodiscard]] size_t size() const noexcept { return m_live; }
 		[[nodiscard]] size_t page_count() const noexcept { return m_pages.size(); }
 
+		//replaces the content with copies of other's, pages that exist in both arrays are reused
+		void copy_from(const SparseArray& other) requires std::copy_constructible<V> {
+			for (size_t i = other.m_pages.size(); i < m_pages.size(); ++i) {
+				destroy_page(m_pages[i]);
+			}
+			m_pages.resize(other.m_pages.size());
+
+			for (size_t i = 0; i < m_pages.size(); ++i) {
+				if (!other.m_pages[i]) {
+					destroy_page(std::exchange(m_pages[i], nullptr));
+					continue;
+				}
+				if (!m_pages[i]) {
+					m_pages[i] = create_page();
+				}
+				m_pages[i]->copy_from(*other.m_pages[i]);
+			}
+			m_live = other.m_live;
+		}
+
 		void clear() noexcept {
+			for (Page* const page : m_pages) {
+				destroy_page(page);
+			}
 			m_pages.clear();
 			m_live = 0;
 		}
@@ -177,6 +232,25 @@ namespace glaze::ecs {
 					}
 				}
 				m_used.reset();
+				m_live = 0;
+			}
+
+			//trivially copyable values are copied with the whole page
+			void copy_from(const Page& other) {
+				if constexpr (std::is_trivially_copyable_v<V>) {
+					m_data = other.m_data;
+				} else {
+					clear();
+					for (size_t i = 0; i < PAGE_SIZE; ++i) {
+						if (other.m_used.test(i)) {
+							std::construct_at(ptr(i), other.get(i));
+							m_used.set(i);
+							++m_live;
+						}
+					}
+				}
+				m_used = other.m_used;
+				m_live = other.m_live;
 			}
 
 			[[nodiscard]] bool contains(const size_t i) const noexcept {
@@ -188,6 +262,13 @@ namespace glaze::ecs {
 				return m_live == 0;
 			}
 
+			//the used bit and the value live in different cache lines
+			void prefetch(const size_t i) const noexcept {
+				assert(i < PAGE_SIZE);
+				utils::prefetch(reinterpret_cast<const std::byte*>(&m_used) + i / 8);
+				utils::prefetch(m_data.data() + i * sizeof(V));
+			}
+
 			[[nodiscard]] auto& get(this auto& self, const size_t i) noexcept {
 				assert(i < PAGE_SIZE);
 				return *self.ptr(i);
@@ -237,7 +318,7 @@ namespace glaze::ecs {
 				return Ptr{nullptr};
 			}
 
-			return static_cast<Ptr>(self.m_pages[page].get());
+			return static_cast<Ptr>(self.m_pages[page]);
 		}
 
 		[[nodiscard]] Page& ensure_page(const size_t page) {
@@ -246,19 +327,37 @@ namespace glaze::ecs {
 			}
 
 			if (!m_pages[page]) {
-				m_pages[page] = std::make_unique<Page>();
+				m_pages[page] = create_page();
 			}
 
 			return *m_pages[page];
 		}
 
+		[[nodiscard]] Page* create_page() {
+			void* const memory = m_allocator.allocate(sizeof(Page), alignof(Page));
+			if (!memory) [[unlikely]] {
+				utils::panic("SparseArray: allocation of a {} bytes page failed", sizeof(Page));
+			}
+			return std::construct_at(static_cast<Page*>(memory));
+		}
+
+		void destroy_page(Page* const page) noexcept {
+			if (!page) {
+				return;
+			}
+			std::destroy_at(page);
+			m_allocator.deallocate(page, sizeof(Page), alignof(Page));
+		}
+
 		void trim_trailing_empty_pages() noexcept {
 			while (!m_pages.empty() && !m_pages.back()) {
 				m_pages.pop_back();
 			}
 		}
 
-		std::vector<std::unique_ptr<Page>> m_pages;
+		//null for pages without any value
+		std::vector<Page*> m_pages;
 		size_t m_live = 0;
+		utils::Allocator m_allocator;
 	};
 }
\ No newline at end of file
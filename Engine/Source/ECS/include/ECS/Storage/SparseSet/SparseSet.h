@@ -4,13 +4,16 @@
 
 #include "SparseArray.h"
 
+#include "Utils/Allocator.h"
 #include "Utils/SwapRemove.h"
 
 namespace glaze::ecs {
 	template<SparseIndex I, std::move_constructible V, size_t PAGE_SIZE = 4096> requires (PAGE_SIZE > 0)
 	struct SparseSet {
 		SparseSet() = default;
-		explicit SparseSet(const size_t capacity) {
+		//dense values, their indices and the sparse pages are allocated through allocator
+		explicit SparseSet(const size_t capacity, const utils::Allocator allocator = {})
+			: m_dense(allocator), m_indices(allocator), m_sparse(allocator) {
 			m_dense.reserve(capacity);
 			m_indices.reserve(capacity);
 		}
@@ -78,9 +81,11 @@ namespace glaze::ecs {
 			return std::views::zip(std::as_const(self.m_indices), self.m_dense);
 		}
 
-		[[nodiscard]] const std::vector<I>& indices() const noexcept { return m_indices; }
+		[[nodiscard]] const auto& indices() const noexcept { return m_indices; }
 		[[nodiscard]] auto& values(this auto& self) noexcept { return self.m_dense; }
 
+		void prefetch(const I index) const noexcept { m_sparse.prefetch(index); }
+
 		[[nodiscard]] bool contains(const I index) const noexcept { return m_sparse.contains(index); }
 		[[nodiscard]] bool empty() const noexcept { return m_dense.empty(); }
 
@@ -94,6 +99,13 @@ namespace glaze::ecs {
 			m_sparse.reserve(cap);
 		}
 
+		//replaces the content with copies of other's, keeping the allocations
+		void copy_from(const SparseSet& other) requires std::copyable<V> {
+			m_dense = other.m_dense;
+			m_indices = other.m_indices;
+			m_sparse.copy_from(other.m_sparse);
+		}
+
 		void clear() {
 			m_dense.clear();
 			m_indices.clear();
@@ -101,8 +113,8 @@ namespace glaze::ecs {
 		}
 
 	private:
-		std::vector<V> m_dense;
-		std::vector<I> m_indices;
+		std::vector<V, utils::StdAllocator<V>> m_dense;
+		std::vector<I, utils::StdAllocator<I>> m_indices;
 		SparseArray<I, size_t, PAGE_SIZE> m_sparse;
 	};
 }
@@ -6,29 +6,42 @@
 
 namespace glaze::ecs {
 	struct Storage {
+		Storage() = default;
+
+		//component data of tables and sparse sets is allocated through allocator
+		explicit Storage(const utils::Allocator allocator)
+			: table_manager(allocator), m_allocator(allocator) {
+		}
+
 		void ensure_component(const ComponentMeta& component) {
 			if (component.storage_type() == StorageType::SparseSet) {
 				if (!sparse_sets.contains(component.id())) {
-					sparse_sets.emplace(component.id(), component, 64);
+					sparse_sets.emplace(component.id(), component, 64, m_allocator);
 				}
 			}
 		}
 
+		//column or sparse set every component of a bundle is written to, resolved once so many bundles can be written into the same table
 		template<Bundle B>
-		void write_bundle(B&& bundle, const Entity entity, const EntityLocation& location, const BundleMeta& bundle_meta) {
-			visit_bundle_enumerate(std::forward<B>(bundle), [&]<Component C>(const size_t index, C&& c) {
-				using T = std::remove_cvref_t<C>;
-				const auto component_id = bundle_meta.components()[index];
-
-				if constexpr (get_storage_type<T>() == StorageType::Table) {
-					auto& table = table_manager.at(location.table_id);
-					auto& column = utils::value_or_panic_debug(table.at(component_id));
-					column.insert(location.table_row.to_index(), std::forward_like<C>(c));
-				} else {
-					auto& sparse_set = utils::value_or_panic_debug(sparse_sets.at(component_id));
-					sparse_set.insert(entity, std::forward_like<C>(c));
-				}
-			});
+		[[nodiscard]] auto bundle_targets(const TableId table_id, const BundleMeta& bundle_meta) {
+			using Tuple = BundleComponentTypes<B>;
+			return [&]<size_t... I>(std::index_sequence<I...>) {
+				return std::tuple{ component_target<std::remove_cvref_t<std::tuple_element_t<I, Tuple>>>(table_id, bundle_meta.components()[I])... };
+			}(std::make_index_sequence<std::tuple_size_v<Tuple>>{});
+		}
+
+		template<Bundle B>
+		void write_bundle(B&& bundle, const Entity entity, const EntityLocation& location, const BundleMeta& bundle_meta, const Tick change_tick) {
+			const auto targets = bundle_targets<B>(location.table_id, bundle_meta);
+			write_bundle(std::forward<B>(bundle), entity, location.table_row, targets, change_tick);
+		}
+
+		template<Bundle B, typename Targets>
+		static void write_bundle(B&& bundle, const Entity entity, const TableRow table_row, const Targets& targets, const Tick change_tick) {
+			auto components = std::forward<B>(bundle).components();
+			[&]<size_t... I>(std::index_sequence<I...>) {
+				(write_component(*std::get<I>(targets), entity, table_row, std::forward_like<B>(std::get<I>(components)), change_tick), ...);
+			}(std::make_index_sequence<std::tuple_size_v<Targets>>{});
 		}
 
 		[[nodiscard]] auto& operator[](this auto& self, const TableId id) noexcept {
@@ -40,8 +53,31 @@ namespace glaze::ecs {
 		}
 
 		[[nodiscard]] auto& empty_table(this auto& self) noexcept { return self.table_manager.empty_table(); }
+		[[nodiscard]] const utils::Allocator& allocator() const noexcept { return m_allocator; }
 
 		SparseSet<ComponentId, ComponentSparseSet> sparse_sets;
 		TableManager table_manager;
+
+	private:
+		utils::Allocator m_allocator;
+
+		template<Component T>
+		[[nodiscard]] auto* component_target(const TableId table_id, const ComponentId component_id) {
+			if constexpr (get_storage_type<T>() == StorageType::Table) {
+				return &utils::value_or_panic_debug(table_manager.at(table_id).at(component_id));
+			} else {
+				return &utils::value_or_panic_debug(sparse_sets.at(component_id));
+			}
+		}
+
+		template<typename C>
+		static void write_component(Column& column, const Entity, const TableRow table_row, C&& c, const Tick change_tick) {
+			column.insert(table_row.to_index(), std::forward<C>(c), change_tick);
+		}
+
+		template<typename C>
+		static void write_component(ComponentSparseSet& sparse_set, const Entity entity, const TableRow, C&& c, const Tick change_tick) {
+			sparse_set.insert(entity, std::forward<C>(c), change_tick);
+		}
 	};
 }
\ No newline at end of file
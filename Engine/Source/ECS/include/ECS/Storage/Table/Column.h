@@ -0,0 +1,131 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include "ECS/Component/ComponentTicks.h"
+#include "ECS/Storage/TypeErasedArray.h"
+#include "Utils/SwapRemove.h"
+
+namespace glaze::ecs {
+	//component data of one table column with the added and changed ticks of every row
+	//and the newest of them for the whole column, data and ticks of chunked tables are chunked with the same rows
+	struct Column {
+		Column(const utils::Layout& layout, const utils::TypeOps& type_ops, const size_t chunk_rows = 0, const utils::Allocator allocator = {}) noexcept
+			: m_data(layout, type_ops, 0, chunk_rows, allocator),
+			  m_ticks(utils::Layout::of<ComponentTicks>(), utils::TypeOps::of<ComponentTicks>(), 0, chunk_rows, allocator) {
+		}
+
+		Column(const Column& other) = delete;
+		Column& operator=(const Column& other) = delete;
+
+		Column(Column&& other) noexcept = default;
+		Column& operator=(Column&& other) noexcept = default;
+
+		//appending a row marks it as added, replacing an existing one only as changed
+		template<typename T>
+		void insert(const size_t index, T&& value, const Tick tick) {
+			m_data.insert(index, std::forward<T>(value));
+			set_ticks(index, ComponentTicks{ tick, tick });
+		}
+
+		void swap_remove(const size_t index) noexcept {
+			m_data.swap_remove(index);
+			m_ticks.swap_remove(index);
+		}
+
+		void swap_remove_many(const std::span<const size_t> sorted_indices, const std::span<const utils::SwapRemoveMove> moves) noexcept {
+			m_data.swap_remove_many(sorted_indices, moves);
+			m_ticks.swap_remove_many(sorted_indices, moves);
+		}
+
+		//appends the row of src and fills its hole with src's last row, the value is relocated rather than moved and destroyed
+		void take_row(Column& src, const size_t index) {
+			assert(index < src.size());
+			m_data.relocate_emplace_back(src.m_data.get(index));
+			src.m_data.swap_remove_relocated(index);
+			set_ticks(m_ticks.size(), src.ticks(index));
+			src.m_ticks.swap_remove(index);
+		}
+
+		//appends count rows copied from the bytes at src, marked as added at tick, only for trivially copyable components
+		void append_bytes(const std::byte* const src, const size_t count, const Tick tick) {
+			if (count == 0) {
+				return;
+			}
+			m_data.append_bytes(src, count);
+			m_ticks.resize(m_ticks.size() + count, [tick](void* const p, size_t) {
+				std::construct_at(static_cast<ComponentTicks*>(p), tick, tick);
+			});
+			m_added_tick.raise(tick);
+			m_changed_tick.raise(tick);
+		}
+
+		//replaces the rows and ticks with copies of other's, keeping the allocations
+		void copy_from(const Column& other) {
+			m_data.copy_from(other.m_data);
+			m_ticks.copy_from(other.m_ticks);
+			m_added_tick = other.m_added_tick;
+			m_changed_tick = other.m_changed_tick;
+		}
+
+		void clear() noexcept {
+			m_data.resize(0);
+			m_ticks.resize(0);
+		}
+
+		//safe to call concurrently for distinct rows
+		void mark_changed(const size_t index, const Tick tick) noexcept {
+			m_ticks.get<ComponentTicks>(index)->changed = tick;
+			m_changed_tick.raise(tick);
+		}
+
+		void mark_changed(const size_t offset, const size_t length, const Tick tick) noexcept {
+			if (length == 0) {
+				return;
+			}
+			//callers slice within a chunk, so the ticks are contiguous as well
+			for (auto& ticks : m_ticks.get_slice<ComponentTicks>(offset, length)) {
+				ticks.changed = tick;
+			}
+			m_changed_tick.raise(tick);
+		}
+
+		void reserve(const size_t additional) {
+			m_data.reserve(m_data.size() + additional);
+			m_ticks.reserve(m_ticks.size() + additional);
+		}
+
+		//clamps the ticks of every row and the watermarks, see Tick::clamp
+		void check_ticks(const Tick this_run) noexcept {
+			for (size_t i = 0; i < m_ticks.size(); ++i) {
+				m_ticks.get<ComponentTicks>(i)->clamp(this_run);
+			}
+			m_added_tick.clamp(this_run);
+			m_changed_tick.clamp(this_run);
+		}
+
+		[[nodiscard]] auto& data(this auto& self) noexcept { return self.m_data; }
+		[[nodiscard]] ComponentTicks ticks(const size_t index) const noexcept { return *m_ticks.get<ComponentTicks>(index); }
+		//newest added and changed tick of any row, removing rows doesn't lower them
+		[[nodiscard]] Tick added_tick() const noexcept { return m_added_tick.get(); }
+		[[nodiscard]] Tick changed_tick() const noexcept { return m_changed_tick.get(); }
+		[[nodiscard]] size_t size() const noexcept { return m_data.size(); }
+
+	private:
+		void set_ticks(const size_t index, const ComponentTicks ticks) {
+			if (index == m_ticks.size()) {
+				m_ticks.push_back(ticks);
+				m_added_tick.raise(ticks.added);
+			} else {
+				m_ticks.get<ComponentTicks>(index)->changed = ticks.changed;
+			}
+			m_changed_tick.raise(ticks.changed);
+		}
+
+		TypeErasedArray m_data;
+		TypeErasedArray m_ticks;
+		TickWatermark m_added_tick;
+		TickWatermark m_changed_tick;
+	};
+}
@@ -1,13 +1,30 @@
 #pragma once
 
+#include <algorithm>
+#include <limits>
+#include <ranges>
+
 #include "ECS/Entity.h"
-#include "ECS/Storage/TypeErasedArray.h"
+#include "ECS/Storage/Table/Column.h"
 #include "ECS/Storage/SparseSet/SparseSet.h"
 
 namespace glaze::ecs {
+	//rows [offset, offset + length) of a table
+	struct TableRows {
+		size_t offset;
+		size_t length;
+	};
+
+	//entities and columns of a chunked table store the same chunk_rows rows per chunk,
+	//so growing it never moves a row and every chunk can be sliced like a small contiguous table
 	struct Table {
-		explicit Table(const TableId id) noexcept
-			: m_id(id) {
+		static constexpr size_t NO_COLUMN = std::numeric_limits<size_t>::max();
+
+		//chunk_rows has to be a power of two, 0 keeps the rows contiguous
+		//entities and column data are allocated through allocator
+		explicit Table(const TableId id, const size_t chunk_rows = 0, const utils::Allocator allocator = {}) noexcept
+			: m_entities(utils::Layout::of<Entity>(), utils::TypeOps::of<Entity>(), 0, chunk_rows, allocator),
+			  m_id(id) {
 		}
 
 		Table(const Table& other) = delete;
@@ -17,24 +34,43 @@ namespace glaze::ecs {
 		Table& operator=(Table&& other) noexcept = default;
 
 		void add_column(const ComponentMeta& component_meta) {
-			m_columns.emplace(component_meta.id(), component_meta.layout(), component_meta.type_ops());
+			m_columns.emplace(component_meta.id(), component_meta.layout(), component_meta.type_ops(), m_entities.chunk_rows(), m_entities.allocator());
+		}
+
+		//column of dst for every column of this table, NO_COLUMN if dst doesn't store the component
+		[[nodiscard]] std::vector<size_t> column_map(const Table& dst) const {
+			std::vector<size_t> columns;
+			columns.reserve(m_columns.size());
+			for (const auto component_id : m_columns.indices()) {
+				columns.push_back(dst.m_columns.contains(component_id) ? dst.column_index(component_id) : NO_COLUMN);
+			}
+			return columns;
 		}
 
+		//moves the row into dst following a column map made by column_map(dst), values of dropped columns are destroyed
 		//returns a valid entity that has been put into the removed entity place and a table row
 		//nullopt if last because there's no valid entity then
-		[[nodiscard]] std::pair<std::optional<Entity>, TableRow> move_to(Table& dst, const TableRow table_row) {
+		[[nodiscard]] std::pair<std::optional<Entity>, TableRow> move_to(Table& dst, const TableRow table_row, const std::span<const size_t> columns) {
 			const auto index = table_row.to_index();
 			assert(index < entity_count());
+			assert(columns.size() == m_columns.size());
 			const bool is_last = index == entity_count() - 1;
 
-			const auto new_table_row = dst.add_entity(utils::swap_remove(m_entities, index));
-			for (const auto& [component_id, src_column] : m_columns.iter()) {
-				auto& new_column = utils::value_or_panic(dst.at(component_id));
-				new_column.move_insert(new_table_row.to_index(), src_column.get(index));
-				src_column.swap_remove(index);
+			const auto new_table_row = dst.add_entity(entity_at(index));
+			m_entities.swap_remove(index);
+			auto& src_columns = m_columns.values();
+			auto& dst_columns = dst.m_columns.values();
+			for (size_t i = 0; i < src_columns.size(); ++i) {
+				auto& src_column = src_columns[i];
+				if (columns[i] != NO_COLUMN) {
+					assert(dst_columns[columns[i]].size() == new_table_row.to_index());
+					dst_columns[columns[i]].take_row(src_column, index);
+				} else {
+					src_column.swap_remove(index);
+				}
 			}
 
-			return { is_last ? std::nullopt : std::make_optional(m_entities[index]), new_table_row };
+			return { is_last ? std::nullopt : std::make_optional(entity_at(index)), new_table_row };
 		}
 
 		[[nodiscard]] TableRow add_entity(const Entity entity) {
@@ -42,6 +78,31 @@ namespace glaze::ecs {
 			return TableRow::from_index(m_entities.size() - 1);
 		}
 
+		//appends the entities without touching the columns, which the caller fills with the same number of rows
+		TableRow append_entities(const std::span<const Entity> entities) {
+			const auto first = TableRow::from_index(m_entities.size());
+			m_entities.append_bytes(reinterpret_cast<const std::byte*>(entities.data()), entities.size());
+			return first;
+		}
+
+		//replaces the rows with copies of other's, which has to store the same components
+		void copy_from(const Table& other) {
+			assert(std::ranges::equal(components(), other.components()));
+			m_entities.copy_from(other.m_entities);
+			auto& columns = m_columns.values();
+			const auto& other_columns = other.m_columns.values();
+			for (size_t i = 0; i < columns.size(); ++i) {
+				columns[i].copy_from(other_columns[i]);
+			}
+		}
+
+		void clear() noexcept {
+			m_entities.resize(0);
+			for (auto& column : m_columns.values()) {
+				column.clear();
+			}
+		}
+
 		[[nodiscard]] std::optional<Entity> remove_entity(const TableRow row) noexcept {
 			const auto index = row.to_index();
 			assert(m_entities.size() > index);
@@ -50,35 +111,96 @@ namespace glaze::ecs {
 			}
 
 			const bool is_last = index == m_entities.size() - 1;
-			utils::swap_remove(m_entities, index);
+			m_entities.swap_remove(index);
 
 			if (is_last) {
 				return std::nullopt;
 			}
 
-			return m_entities[index];
+			return entity_at(index);
+		}
+
+		//room for additional rows in the entity list and every column
+		void reserve(const size_t additional) {
+			m_entities.reserve(m_entities.size() + additional);
+			for (auto& column : m_columns.values()) {
+				column.reserve(additional);
+			}
+		}
+
+		//removes the sorted unique rows in one pass filling the holes from the end of the table
+		//on_moved(entity, row) is called for every entity that has been moved into a hole
+		template<typename F>
+		void remove_entities(const std::span<const size_t> sorted_rows, F&& on_moved) {
+			const auto moves = utils::swap_remove_moves(sorted_rows, m_entities.size());
+			for (auto& column : m_columns.values()) {
+				column.swap_remove_many(sorted_rows, moves);
+			}
+
+			m_entities.swap_remove_many(sorted_rows, moves);
+			for (const auto [from, to] : moves) {
+				on_moved(entity_at(to), TableRow::from_index(to));
+			}
 		}
 
 		[[nodiscard]] TableId id() const noexcept { return m_id; }
+		//all entities, only for tables that aren't chunked
+		[[nodiscard]] std::span<const Entity> entities() const noexcept {
+			assert(!m_entities.chunked() && "Entities of a chunked table are only contiguous within a chunk, use chunks()");
+			return entities({ 0, entity_count() });
+		}
+
+		//entities of rows that don't cross a chunk boundary
+		[[nodiscard]] std::span<const Entity> entities(const TableRows rows) const noexcept {
+			if (rows.length == 0) {
+				return {};
+			}
+			return m_entities.get_slice<Entity>(rows.offset, rows.length);
+		}
+
+		//row ranges sharing a chunk, a table that isn't chunked is a single range
+		[[nodiscard]] auto chunks() const noexcept {
+			const size_t count = entity_count();
+			const size_t step = m_entities.chunked() ? m_entities.chunk_rows() : std::max<size_t>(count, 1);
+			return std::views::iota(size_t{0}, (count + step - 1) / step) | std::views::transform([count, step](const size_t i) {
+				return TableRows{ i * step, std::min(step, count - i * step) };
+			});
+		}
+
+		//rows per chunk, 0 if the table isn't chunked
+		[[nodiscard]] size_t chunk_rows() const noexcept { return m_entities.chunk_rows(); }
 
 		[[nodiscard]] auto& operator[](this auto& self, const ComponentId id) noexcept {
 			return self.m_columns[id];
 		}
 
-		[[nodiscard]] utils::optional_ref<TypeErasedArray> at(const ComponentId id) noexcept {
+		[[nodiscard]] utils::optional_ref<Column> at(const ComponentId id) noexcept {
 			return m_columns.at(id);
 		}
 
-		[[nodiscard]] utils::optional_ref<const TypeErasedArray> at(const ComponentId id) const noexcept {
+		[[nodiscard]] utils::optional_ref<const Column> at(const ComponentId id) const noexcept {
 			return m_columns.at(id);
 		}
 
+		//components of the columns, in column order
+		[[nodiscard]] const auto& components() const noexcept { return m_columns.indices(); }
+
+		[[nodiscard]] Entity entity(const size_t row) const noexcept { return entity_at(row); }
+
 		[[nodiscard]] size_t entity_count() const noexcept { return m_entities.size(); }
 		[[nodiscard]] size_t component_count() const noexcept { return m_columns.size(); }
 
 	private:
-		std::vector<Entity> m_entities;
-		SparseSet<ComponentId, TypeErasedArray> m_columns;
+		[[nodiscard]] Entity entity_at(const size_t index) const noexcept {
+			return *m_entities.get<Entity>(index);
+		}
+
+		[[nodiscard]] size_t column_index(const ComponentId id) const noexcept {
+			return static_cast<size_t>(&m_columns[id] - m_columns.values().data());
+		}
+
+		TypeErasedArray m_entities;
+		SparseSet<ComponentId, Column> m_columns;
 		TableId m_id;
 	};
 }
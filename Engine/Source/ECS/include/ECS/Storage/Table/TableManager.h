@@ -1,5 +1,8 @@
 #pragma once
 
+#include <algorithm>
+#include <bit>
+
 #include "Utils/Panic.h"
 #include "ECS/Component/ComponentManager.h"
 #include "ECS/Component/ComponentSignature.h"
@@ -8,9 +11,13 @@
 
 namespace glaze::ecs {
 	struct TableManager {
-		TableManager() {
+		static constexpr size_t DEFAULT_CHUNK_BYTES = 16 * 1024;
+
+		//rows of every table are allocated through allocator
+		explicit TableManager(const utils::Allocator allocator = {})
+			: m_allocator(allocator) {
 			//insert empty table for entities without components
-			m_tables.emplace_back(EMPTY_TABLE_ID);
+			m_tables.emplace_back(EMPTY_TABLE_ID, 0, m_allocator);
 		}
 
 		[[nodiscard]] TableId try_emplace(
@@ -29,7 +36,7 @@ namespace glaze::ecs {
 
 			const auto table_id = TableId::from_index(m_tables.size());
 			m_by_components.emplace(table_key, table_id);
-			auto& table = m_tables.emplace_back(table_id);
+			auto& table = m_tables.emplace_back(table_id, chunk_rows(table_components, component_manager), m_allocator);
 
 			for (const auto component_id : table_components) {
 				table.add_column(component_manager[component_id]);
@@ -47,6 +54,11 @@ namespace glaze::ecs {
 			return m_tables[index].add_entity(entity);
 		}
 
+		//tables created afterwards store their rows in chunks of about bytes, each allocated once and never moved
+		//0 keeps the rows of new tables contiguous, which is the default
+		void set_chunk_bytes(const size_t bytes) noexcept { m_chunk_bytes = bytes; }
+		[[nodiscard]] size_t chunk_bytes() const noexcept { return m_chunk_bytes; }
+
 		[[nodiscard]] std::span<const Table> tables() const noexcept { return m_tables; }
 		[[nodiscard]] auto& empty_table(this auto& self) noexcept { return self.m_tables[EMPTY_TABLE_ID.to_index()]; }
 
@@ -67,7 +79,22 @@ namespace glaze::ecs {
 		[[nodiscard]] bool empty() const noexcept { return m_tables.empty(); }
 
 	private:
+		//rows of all columns, their ticks and the entity of one chunk fit into chunk_bytes
+		[[nodiscard]] size_t chunk_rows(const std::span<const ComponentId> table_components, const ComponentManager& component_manager) const noexcept {
+			if (m_chunk_bytes == 0) {
+				return 0;
+			}
+
+			size_t row_bytes = sizeof(Entity);
+			for (const auto component_id : table_components) {
+				row_bytes += component_manager[component_id].layout().size() + sizeof(ComponentTicks);
+			}
+			return std::bit_floor(std::max<size_t>(m_chunk_bytes / row_bytes, 1));
+		}
+
 		std::vector<Table> m_tables;
 		ByComponentsMap<TableId> m_by_components;
+		size_t m_chunk_bytes = 0;
+		utils::Allocator m_allocator;
 	};
 }
@@ -1,11 +1,26 @@
 #pragma once
 
+#include <bit>
 #include <cassert>
+#include <cstring>
+#include <limits>
+#include <utility>
+#include <vector>
 
+#include "Utils/Allocator.h"
 #include "Utils/Layout.h"
 #include "Utils/Panic.h"
+#include "Utils/SwapRemove.h"
 #include "Utils/TypeOps.h"
 
+/*
+	Array of elements whose type is only known through its layout and type ops.
+
+	Elements are either contiguous, growing by reallocation, or chunked:
+	a chunked array stores chunk_rows elements per separately allocated chunk, so growing only ever allocates a new chunk
+	and elements never move. Slices of a chunked array can't cross a chunk boundary.
+	Memory comes from the allocator the array was created with, the global heap by default.
+ */
 namespace glaze::ecs {
 	struct TypeErasedArray {
 		using Layout = utils::Layout;
@@ -13,8 +28,10 @@ namespace glaze::ecs {
 
 		TypeErasedArray() = default;
 
-		TypeErasedArray(const Layout& layout, const TypeOps& type_ops, const size_t capacity = 0) noexcept
-			: m_layout(layout), m_type_ops(type_ops) {
+		//chunk_rows has to be a power of two, 0 keeps the elements contiguous
+		TypeErasedArray(const Layout& layout, const TypeOps& type_ops, const size_t capacity = 0, const size_t chunk_rows = 0, const utils::Allocator allocator = {}) noexcept
+			: m_layout(layout), m_type_ops(type_ops), m_allocator(allocator), m_chunk_rows(chunk_rows), m_chunk_shift(static_cast<size_t>(std::countr_zero(chunk_rows))) {
+			assert((chunk_rows == 0 || std::has_single_bit(chunk_rows)) && "Chunk rows have to be a power of two");
 			reserve(capacity);
 		}
 
@@ -26,7 +43,11 @@ namespace glaze::ecs {
 		TypeErasedArray(TypeErasedArray&& other) noexcept
 			: m_layout(std::exchange(other.m_layout, {})),
 			  m_type_ops(std::exchange(other.m_type_ops, {})),
+			  m_allocator(other.m_allocator),
 			  m_data(std::exchange(other.m_data, nullptr)),
+			  m_chunks(std::exchange(other.m_chunks, {})),
+			  m_chunk_rows(std::exchange(other.m_chunk_rows, 0)),
+			  m_chunk_shift(std::exchange(other.m_chunk_shift, 0)),
 			  m_size(std::exchange(other.m_size, 0)),
 			  m_capacity(std::exchange(other.m_capacity, 0)) {
 		}
@@ -37,7 +58,11 @@ namespace glaze::ecs {
 
 				m_layout   = std::exchange(other.m_layout, {});
 				m_type_ops = std::exchange(other.m_type_ops, {});
+				m_allocator = other.m_allocator;
 				m_data     = std::exchange(other.m_data, nullptr);
+				m_chunks   = std::exchange(other.m_chunks, {});
+				m_chunk_rows  = std::exchange(other.m_chunk_rows, 0);
+				m_chunk_shift = std::exchange(other.m_chunk_shift, 0);
 				m_size     = std::exchange(other.m_size, 0);
 				m_capacity = std::exchange(other.m_capacity, 0);
 			}
@@ -111,12 +136,71 @@ namespace glaze::ecs {
 
 			ensure_capacity_for(src.size());
 
+			if constexpr (std::is_trivially_copyable_v<T>) {
+				if (!chunked()) {
+					std::memcpy(get(m_size), src.data(), src.size_bytes());
+					m_size += src.size();
+					return;
+				}
+			}
+
 			for (T& v : src) {
 				m_type_ops.move_construct(get(m_size), std::addressof(v));
 				++m_size;
 			}
 		}
 
+		//appends count elements copied from the bytes at src, only for trivially copyable types
+		void append_bytes(const std::byte* src, size_t count) noexcept {
+			assert(m_type_ops.trivially_copyable && "Only trivially copyable elements can be copied as bytes");
+
+			ensure_capacity_for(count);
+			if (zst()) {
+				m_size += count;
+				return;
+			}
+
+			while (count > 0) {
+				const size_t run = std::min(count, run_length(m_size));
+				std::memcpy(get(m_size), src, run * m_layout.size());
+				src += run * m_layout.size();
+				m_size += run;
+				count -= run;
+			}
+		}
+
+		//replaces the elements with copies of other's, the allocation is kept if it's big enough
+		//trivially copyable elements are copied with one memcpy per run of rows contiguous in both arrays
+		void copy_from(const TypeErasedArray& other) {
+			assert(m_layout == other.m_layout);
+			destroy_range(0, m_size);
+			m_size = 0;
+			reserve(other.m_size);
+
+			if (zst()) {
+				m_size = other.m_size;
+				return;
+			}
+
+			if (m_type_ops.trivially_copyable) {
+				for (size_t index = 0; index < other.m_size;) {
+					const size_t run = std::min({ other.m_size - index, run_length(index), other.run_length(index) });
+					std::memcpy(get(index), other.get(index), run * m_layout.size());
+					index += run;
+				}
+				m_size = other.m_size;
+				return;
+			}
+
+			if (!m_type_ops.copy_construct) [[unlikely]] {
+				utils::panic("TypeErasedArray: elements aren't copy constructible");
+			}
+			for (size_t i = 0; i < other.m_size; ++i) {
+				m_type_ops.copy_construct(get(i), other.get(i));
+				m_size = i + 1;
+			}
+		}
+
 		template<typename T>
 		[[nodiscard]] T* get(const size_t index) noexcept {
 			assert(index < m_size && "Index out of bounds");
@@ -141,6 +225,7 @@ namespace glaze::ecs {
 		[[nodiscard]] std::span<T> get_slice(const size_t index, const size_t length) noexcept {
 			assert(!zst() && "Slices for ZST are meaningless");
 			assert(index + length <= m_size && "Slice out of bounds");
+			assert(in_one_chunk(index, length) && "Slice crosses a chunk boundary");
 			return std::span(get<T>(index), length);
 		}
 
@@ -148,6 +233,7 @@ namespace glaze::ecs {
 		[[nodiscard]] std::span<const T> get_slice(const size_t index, const size_t length) const noexcept {
 			assert(!zst() && "Slices for ZST are meaningless");
 			assert(index + length <= m_size && "Slice out of bounds");
+			assert(in_one_chunk(index, length) && "Slice crosses a chunk boundary");
 			return std::span(get<T>(index), length);
 		}
 
@@ -218,13 +304,23 @@ namespace glaze::ecs {
 			return get(index);
 		}
 
-		[[nodiscard]] void* get(const size_t index) noexcept {
+		//moves the value into a new last element and destroys the source, which the caller must not touch anymore
+		void* relocate_emplace_back(void* const v) {
 			if (zst()) {
+				ensure_capacity_for(1);
+				++m_size;
 				return nullptr;
 			}
-			assert(index < m_capacity && "Index out of capacity bounds");
-			assert(m_data && "No backing storage");
-			return m_data + index * m_layout.size();
+
+			ensure_capacity_for(1);
+			void* const slot = get(m_size);
+			relocate(slot, v);
+			++m_size;
+			return slot;
+		}
+
+		[[nodiscard]] void* get(const size_t index) noexcept {
+			return const_cast<void*>(std::as_const(*this).get(index));
 		}
 
 		[[nodiscard]] const void* get(const size_t index) const noexcept {
@@ -232,6 +328,9 @@ namespace glaze::ecs {
 				return nullptr;
 			}
 			assert(index < m_capacity && "Index out of capacity bounds");
+			if (chunked()) {
+				return m_chunks[index >> m_chunk_shift] + (index & (m_chunk_rows - 1)) * m_layout.size();
+			}
 			assert(m_data && "No backing storage");
 			return m_data + index * m_layout.size();
 		}
@@ -246,15 +345,29 @@ namespace glaze::ecs {
 				return;
 			}
 
+			if (chunked()) {
+				m_chunks.reserve((new_capacity + m_chunk_rows - 1) >> m_chunk_shift);
+				while (m_capacity < new_capacity) {
+					m_chunks.push_back(allocate_bytes(m_chunk_rows));
+					m_capacity += m_chunk_rows;
+				}
+				return;
+			}
+
 			std::byte* new_data = allocate_bytes(new_capacity);
 			assert(new_data && "Allocation failed");
 
-			for (size_t i = 0; i < m_size; ++i) {
-				m_type_ops.move_construct(new_data + i * m_layout.size(), get(i));
-				m_type_ops.destruct(get(i));
+			if (m_type_ops.trivially_relocatable) {
+				if (m_size > 0) {
+					std::memcpy(new_data, m_data, m_size * m_layout.size());
+				}
+			} else {
+				for (size_t i = 0; i < m_size; ++i) {
+					relocate(new_data + i * m_layout.size(), get(i));
+				}
 			}
 
-			deallocate_bytes(m_data);
+			deallocate_bytes(m_data, m_capacity);
 			m_data = new_data;
 			m_capacity = new_capacity;
 		}
@@ -271,9 +384,7 @@ namespace glaze::ecs {
 			}
 
 			if (new_size < m_size) {
-				for (size_t i = new_size; i < m_size; ++i) {
-					m_type_ops.destruct(get(i));
-				}
+				destroy_range(new_size, m_size);
 				m_size = new_size;
 				return;
 			}
@@ -300,9 +411,7 @@ namespace glaze::ecs {
 			}
 
 			if (new_size < m_size) {
-				for (size_t i = new_size; i < m_size; ++i) {
-					m_type_ops.destruct(get(i));
-				}
+				destroy_range(new_size, m_size);
 				m_size = new_size;
 				return;
 			}
@@ -337,12 +446,16 @@ namespace glaze::ecs {
 			void* const ptr_to_keep = get(index_to_keep);
 			void* const ptr_to_remove = get(index_to_remove);
 
-			if (index_to_remove != index_to_keep) {
+			if (index_to_remove == index_to_keep) {
+				destroy(ptr_to_keep);
+			} else if (m_type_ops.trivially_relocatable) {
+				destroy(ptr_to_remove);
+				std::memcpy(ptr_to_remove, ptr_to_keep, m_layout.size());
+			} else {
 				m_type_ops.move_assign(ptr_to_remove, ptr_to_keep);
+				m_type_ops.destruct(ptr_to_keep);
 			}
 
-			m_type_ops.destruct(ptr_to_keep);
-
 			--m_size;
 		}
 
@@ -350,13 +463,49 @@ namespace glaze::ecs {
 			swap_remove(index, m_size - 1);
 		}
 
+		//removes the sorted unique indices at once, moves come from utils::swap_remove_moves
+		void swap_remove_many(const std::span<const size_t> sorted_indices, const std::span<const utils::SwapRemoveMove> moves) noexcept {
+			assert(sorted_indices.size() <= m_size);
+
+			if (!zst()) {
+				if (!m_type_ops.trivially_destructible) {
+					for (const auto index : sorted_indices) {
+						m_type_ops.destruct(get(index));
+					}
+				}
+				for (const auto [from, to] : moves) {
+					relocate(get(to), get(from));
+				}
+			}
+
+			m_size -= sorted_indices.size();
+		}
+
+		//like swap_remove but the element has already been relocated out with relocate_emplace_back, so it isn't destroyed again
+		void swap_remove_relocated(const size_t index) noexcept {
+			assert(index < m_size && "Index out of bounds");
+
+			const size_t last = m_size - 1;
+			if (!zst() && index != last) {
+				relocate(get(index), get(last));
+			}
+
+			--m_size;
+		}
+
 		[[nodiscard]] bool zst() const noexcept { return m_layout.size() == 0; }
 		[[nodiscard]] size_t size() const noexcept { return m_size; }
 		[[nodiscard]] size_t capacity() const noexcept { return m_capacity; }
 		[[nodiscard]] bool empty() const noexcept { return m_size == 0; }
 		[[nodiscard]] const Layout& layout() const noexcept { return m_layout; }
 		[[nodiscard]] const TypeOps& type_ops() const noexcept { return m_type_ops; }
+		[[nodiscard]] const utils::Allocator& allocator() const noexcept { return m_allocator; }
 
+		[[nodiscard]] bool chunked() const noexcept { return m_chunk_rows != 0; }
+		//elements per chunk, 0 if the array is contiguous
+		[[nodiscard]] size_t chunk_rows() const noexcept { return m_chunk_rows; }
+
+		//contiguous storage, null for chunked arrays
 		[[nodiscard]] std::byte* data() noexcept { return m_data; }
 		[[nodiscard]] const std::byte* data() const noexcept { return m_data; }
 
@@ -378,41 +527,86 @@ namespace glaze::ecs {
 
 			if (needed <= m_capacity) return;
 
+			//chunks are allocated one at a time, there's nothing to amortize
+			if (chunked()) {
+				reserve(needed);
+				return;
+			}
+
 			const size_t grown = m_capacity == 0 ? std::max<size_t>(needed, 8u) : std::max<size_t>(needed, m_capacity * 2u);
 			reserve(grown);
 		}
 
 		[[nodiscard]] std::byte* allocate_bytes(const size_t capacity) const noexcept {
 			const size_t bytes = capacity * m_layout.size();
-			const auto data = static_cast<std::byte*>(operator new(bytes, static_cast<std::align_val_t>(m_layout.align()), std::nothrow));
+			const auto data = static_cast<std::byte*>(m_allocator.allocate(bytes, m_layout.align()));
 			if (!data) [[unlikely]] {
 				utils::panic("TypeErasedArray: allocation of {} bytes failed", capacity * m_layout.size());
 			}
 			return data;
 		}
 
-		void deallocate_bytes(std::byte* ptr) const noexcept {
+		void deallocate_bytes(std::byte* ptr, const size_t capacity) const noexcept {
 			if (!ptr) {
 				return;
 			}
-			operator delete(ptr, static_cast<std::align_val_t>(m_layout.align()));
+			m_allocator.deallocate(ptr, capacity * m_layout.size(), m_layout.align());
+		}
+
+		//elements from index to the end of its chunk
+		[[nodiscard]] size_t run_length(const size_t index) const noexcept {
+			return chunked() ? m_chunk_rows - (index & (m_chunk_rows - 1)) : std::numeric_limits<size_t>::max();
+		}
+
+		[[nodiscard]] bool in_one_chunk(const size_t index, const size_t length) const noexcept {
+			return !chunked() || length == 0 || (index >> m_chunk_shift) == ((index + length - 1) >> m_chunk_shift);
+		}
+
+		void relocate(void* const dst, void* const src) noexcept {
+			if (m_type_ops.trivially_relocatable) {
+				std::memcpy(dst, src, m_layout.size());
+			} else {
+				m_type_ops.move_construct(dst, src);
+				m_type_ops.destruct(src);
+			}
+		}
+
+		void destroy(void* const ptr) noexcept {
+			if (!m_type_ops.trivially_destructible) {
+				m_type_ops.destruct(ptr);
+			}
+		}
+
+		void destroy_range(const size_t first, const size_t last) noexcept {
+			if (m_type_ops.trivially_destructible) {
+				return;
+			}
+			for (size_t i = first; i < last; ++i) {
+				m_type_ops.destruct(get(i));
+			}
 		}
 
 		void destroy_and_deallocate() noexcept {
-			if (!zst() && m_data) {
-				for (size_t i = 0; i < m_size; ++i) {
-					m_type_ops.destruct(get(i));
+			if (!zst() && (m_data || !m_chunks.empty())) {
+				destroy_range(0, m_size);
+				deallocate_bytes(m_data, m_capacity);
+				for (std::byte* const chunk : m_chunks) {
+					deallocate_bytes(chunk, m_chunk_rows);
 				}
-				deallocate_bytes(m_data);
 			}
 			m_data = nullptr;
+			m_chunks.clear();
 			m_size = 0;
 			m_capacity = 0;
 		}
 
 		Layout m_layout;
 		TypeOps m_type_ops{};
+		utils::Allocator m_allocator;
 		std::byte* m_data = nullptr;
+		std::vector<std::byte*> m_chunks;
+		size_t m_chunk_rows = 0;
+		size_t m_chunk_shift = 0;
 		size_t m_size = 0;
 		size_t m_capacity = 0;
 	};
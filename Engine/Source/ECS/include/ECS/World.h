@@ -1,55 +1,60 @@
 #pragma once
 
-#include <print>
+#include <algorithm>
+#include <ranges>
+#include <tuple>
+#include <vector>
 
 #include "Bundle/BundleManager.h"
+#include "Component/ComponentHooks.h"
 #include "Component/ComponentManager.h"
 #include "Archetype/ArchetypeManager.h"
+#include "Event/Events.h"
+#include "Hierarchy/Hierarchy.h"
+#include "Resource/Resources.h"
 #include "Storage/Storage.h"
 
 #include "Entity.h"
 
 namespace glaze::ecs {
 	struct World {
+		World() = default;
+
+		//component storage is allocated through allocator, e.g. a utils::MemoryArena, which has to outlive the world
+		explicit World(const utils::Allocator allocator)
+			: m_storage(allocator) {
+		}
+
 		Entity create_entity() {
+			flush_entities();
 			const auto entity = m_entity_manager.create_entity();
+			add_to_empty_archetype(entity);
+			return entity;
+		}
 
-			auto& table = m_storage.empty_table();
-			const auto table_row = table.add_entity(entity);
+		//hands out an id without creating the entity, safe to call from several systems running at the same time
+		//the entity is created without components by the next flush_entities, which every structural change runs first
+		[[nodiscard]] Entity reserve_entity() noexcept {
+			return m_entity_manager.reserve_entity();
+		}
 
-			auto& archetype = m_archetype_manager.empty_archetype();
-			const auto location = archetype.add_entity(entity, table_row);
+		void reserve_entities(const std::span<Entity> entities) noexcept {
+			m_entity_manager.reserve_entities(entities);
+		}
 
-			m_entity_manager.set_location(entity, location);
-			return entity;
+		//creates the reserved entities in the empty archetype
+		void flush_entities() {
+			if (m_entity_manager.needs_flush()) {
+				m_entity_manager.flush([this](const Entity entity) { add_to_empty_archetype(entity); });
+			}
 		}
 
 		template<Bundle B>
 		Entity create_entity(B&& bundle) {
-			const auto entity = m_entity_manager.create_entity();
-
-			const auto bundle_id = register_bundle<B>();
-			const auto [archetype_id, table_id] = m_archetype_manager.add_bundle_to_archetype(
-				EMPTY_ARCHETYPE_ID,
-				bundle_id,
-				m_bundle_manager,
-				m_component_manager,
-				m_storage.table_manager);
-
-			auto& archetype = m_archetype_manager[archetype_id];
-			auto& table = m_storage[table_id];
-
-			const auto table_row = table.add_entity(entity);
-			const auto location = archetype.add_entity(entity, table_row);
-
-			m_entity_manager.set_location(entity, location);
-
-			m_storage.write_bundle(
-				std::forward<B>(bundle),
-				entity,
-				location,
-				m_bundle_manager[bundle_id]);
-
+			auto target = spawn_target<std::remove_cvref_t<B>>(0);
+			const auto first_row = target.table->entity_count();
+			const auto entity = spawn_into(target, std::forward<B>(bundle));
+			invoke_spawn_hooks(target, first_row);
 			return entity;
 		}
 
@@ -58,13 +63,53 @@ namespace glaze::ecs {
 			return create_entity(ComponentBundle{ std::forward<Cs>(cs)... });
 		}
 
-		bool destroy_entity(const Entity entity) noexcept {
+		//spawns an entity for every bundle of the range, moving the bundles out of it
+		//the archetype, table and written columns are resolved once and sized ranges reserve room for all entities up front
+		template<std::ranges::input_range R> requires Bundle<std::ranges::range_value_t<R>>
+		std::vector<Entity> spawn_batch(R&& bundles) {
+			size_t count = 0;
+			if constexpr (std::ranges::sized_range<R>) {
+				count = std::ranges::size(bundles);
+			}
+
+			auto target = spawn_target<std::ranges::range_value_t<R>>(count);
+			const auto first_row = target.table->entity_count();
+			std::vector<Entity> entities;
+			entities.reserve(count);
+			for (auto&& bundle : bundles) {
+				entities.push_back(spawn_into(target, std::move(bundle)));
+			}
+			invoke_spawn_hooks(target, first_row);
+			return entities;
+		}
+
+		//spawns count entities with the bundles made by generator(i)
+		template<Bundle B, typename F> requires std::is_invocable_r_v<B, F&, size_t>
+		std::vector<Entity> spawn_n(const size_t count, F&& generator) {
+			auto target = spawn_target<B>(count);
+			const auto first_row = target.table->entity_count();
+			std::vector<Entity> entities;
+			entities.reserve(count);
+			for (size_t i = 0; i < count; ++i) {
+				entities.push_back(spawn_into(target, static_cast<B>(generator(i))));
+			}
+			invoke_spawn_hooks(target, first_row);
+			return entities;
+		}
+
+		//children of the entity become roots and pairs targeting it are removed from their entities
+		bool destroy_entity(const Entity entity) {
+			flush_entities();
+			//both move other entities, which can move this one as well
+			remove_from_hierarchy(entity);
+			remove_pairs_targeting(entity);
+
 			const auto location = m_entity_manager.get_location(entity);
 			if (!location) {
-				std::println("Entity {} does not exist", entity);
 				return false;
 			}
 
+			invoke_remove_hooks(*location, m_archetype_manager[location->archetype_id].components());
 			m_entity_manager.set_location(entity, NULL_ENTITY_LOCATION);
 
 			auto& archetype = m_archetype_manager[location->archetype_id];
@@ -81,31 +126,284 @@ namespace glaze::ecs {
 
 			auto& table = m_storage[archetype.table_id()];
 			if (const auto moved_entity_in_table = table.remove_entity(table_row)) {
-				const auto moved_location = *m_entity_manager.get_location(*moved_entity_in_table);
+				update_moved_table_row(*moved_entity_in_table, table_row);
+			}
 
-				m_entity_manager.update_table_location(*moved_entity_in_table, table_row);
+			return m_entity_manager.destroy_entity(entity);
+		}
 
-				auto& moved_entity_archetype = m_archetype_manager[moved_location.archetype_id];
-				moved_entity_archetype.set_entity_table_row(moved_location.archetype_row, table_row);
+		//destroys all the entities at once, every archetype and table they live in is compacted in a single pass
+		//entities that don't exist are skipped, returns the number of destroyed ones
+		size_t destroy_entities(const std::span<const Entity> entities) {
+			flush_entities();
+			for (const auto entity : entities) {
+				remove_from_hierarchy(entity);
+				remove_pairs_targeting(entity);
 			}
 
-			return m_entity_manager.destroy_entity(entity);
+			const auto removed = remove_entities(entities, true);
+			for (const auto entity : removed) {
+				m_entity_manager.destroy_entity(entity);
+			}
+			return removed.size();
 		}
 
+		//components the entity already has are replaced, the others are moved into the new archetype's table along the cached edge
 		template<Bundle B>
-		void add_bundle(const Entity entity, B&& bundle);
+		void add_bundle(const Entity entity, B&& bundle) {
+			flush_entities();
+			const auto location = m_entity_manager.get_location(entity);
+			if (!location) {
+				utils::panic("Entity {} does not exist", entity);
+			}
+
+			const auto bundle_id = register_bundle<B>();
+			const auto transition = m_archetype_manager.add_bundle_to_archetype(
+				location->archetype_id,
+				bundle_id,
+				m_bundle_manager,
+				m_component_manager,
+				m_storage.table_manager);
+
+			const auto new_location = move_entity(entity, *location, transition);
+
+			m_storage.write_bundle(
+				std::forward<B>(bundle),
+				entity,
+				new_location,
+				m_bundle_manager[bundle_id],
+				m_change_tick.get());
+			invoke_add_hooks(location->archetype_id, new_location, m_bundle_manager[bundle_id].components());
+		}
 
 		template<Component ... Cs> requires (sizeof ... (Cs) > 0)
 		void add_components(const Entity entity, Cs&& ... cs) {
 			return add_bundle(entity, ComponentBundle{ std::forward<Cs>(cs)... });
 		}
 
+		//returns false if the entity doesn't exist or has none of the bundle's components
 		template<Bundle B>
-		bool remove_bundle(const Entity entity) noexcept;
+		bool remove_bundle(const Entity entity) {
+			flush_entities();
+			if (!m_entity_manager.is_valid(entity)) {
+				return false;
+			}
+			return remove_bundle(entity, register_bundle<B>());
+		}
 
 		template<Component ... Cs> requires (sizeof ... (Cs) > 0)
-		bool remove_components(const Entity entity) noexcept {
-			return remove_bundle<ComponentBundle<Cs...>>(entity);
+		bool remove_components(const Entity entity) {
+			return remove_bundle<ComponentBundle<Cs&&...>>(entity);
+		}
+
+		//adds the (R, target) pair to the entity or replaces its value, see ComponentManager::register_pair
+		//panics if the entity or the target doesn't exist
+		template<Component R>
+		void add_pair(const Entity entity, const Entity target, R&& relation = {}) {
+			using U = std::remove_cvref_t<R>;
+			flush_entities();
+			const auto location = m_entity_manager.get_location(entity);
+			if (!location) {
+				utils::panic("Entity {} does not exist", entity);
+			}
+			if (!m_entity_manager.is_valid(target)) {
+				utils::panic("Pair target {} does not exist", target);
+			}
+
+			const auto pair_id = m_component_manager.register_pair<U>(target);
+			const auto transition = m_archetype_manager.add_bundle_to_archetype(
+				location->archetype_id,
+				pair_bundle(pair_id),
+				m_bundle_manager,
+				m_component_manager,
+				m_storage.table_manager);
+
+			const auto new_location = move_entity(entity, *location, transition);
+			if constexpr (get_storage_type<U>() == StorageType::Table) {
+				m_storage[new_location.table_id][pair_id].insert(new_location.table_row.to_index(), std::forward<R>(relation), m_change_tick.get());
+			} else {
+				m_storage[pair_id].insert(entity, std::forward<R>(relation), m_change_tick.get());
+			}
+			invoke_add_hooks(location->archetype_id, new_location, std::span(&pair_id, 1));
+		}
+
+		//false if the entity doesn't have the pair
+		template<Component R>
+		bool remove_pair(const Entity entity, const Entity target) {
+			flush_entities();
+			const auto pair_id = m_component_manager.pair_id(m_component_manager.component_id<R>(), target);
+			if (!has_component(entity, pair_id)) {
+				return false;
+			}
+			return remove_bundle(entity, pair_bundle(pair_id));
+		}
+
+		template<Component R>
+		[[nodiscard]] bool has_pair(const Entity entity, const Entity target) const noexcept {
+			return has_component(entity, m_component_manager.pair_id(m_component_manager.component_id<R>(), target));
+		}
+
+		//(R, *): func is invoked with (Entity, Entity target, const R&) for every pair of the relation an entity has
+		//entities are found through the component index of the relation's pairs, func must not change the world's structure
+		template<Component R, typename F> requires std::invocable<F&, Entity, Entity, const std::remove_cvref_t<R>&>
+		void for_each_pair(F&& func) const {
+			using U = std::remove_cvref_t<R>;
+			for (const auto pair_id : m_component_manager.relation_pairs(m_component_manager.component_id<U>())) {
+				const auto target = m_component_manager[pair_id].target();
+				for_each_with_component(pair_id, [&](const Archetype& archetype, const ArchetypeEntity& archetype_entity) {
+					if constexpr (get_storage_type<U>() == StorageType::Table) {
+						const auto& column = m_storage[archetype.table_id()][pair_id];
+						func(archetype_entity.entity, target, *column.data().template get<U>(archetype_entity.table_row.to_index()));
+					} else {
+						func(archetype_entity.entity, target, m_storage[pair_id].template get<U>(archetype_entity.entity)->get());
+					}
+				});
+			}
+		}
+
+		//(*, target): func is invoked with (Entity, ComponentId relation) for every pair targeting target an entity has
+		//func must not change the world's structure
+		template<typename F> requires std::invocable<F&, Entity, ComponentId>
+		void for_each_targeting(const Entity target, F&& func) const {
+			for (const auto pair_id : m_component_manager.target_pairs(target)) {
+				const auto relation = m_component_manager[pair_id].relation();
+				for_each_with_component(pair_id, [&](const Archetype&, const ArchetypeEntity& archetype_entity) {
+					func(archetype_entity.entity, relation);
+				});
+			}
+		}
+
+		[[nodiscard]] bool has_component(const Entity entity, const ComponentId component_id) const noexcept {
+			const auto location = m_entity_manager.get_location(entity);
+			return location && component_id.valid() && m_archetype_manager[location->archetype_id].has_component(component_id);
+		}
+
+		//func is invoked with (std::span<const Entity>, std::span<const T>) for batches of entities T was added to, see ComponentHooks
+		template<Component T, typename F>
+		void on_add(F&& func) {
+			add_hook<T>(register_component<std::remove_cvref_t<T>>(), ComponentHook::Add, std::forward<F>(func));
+		}
+
+		//func is invoked with the new values of entities which already had T
+		template<Component T, typename F>
+		void on_replace(F&& func) {
+			add_hook<T>(register_component<std::remove_cvref_t<T>>(), ComponentHook::Replace, std::forward<F>(func));
+		}
+
+		//func is invoked with the values of entities which are about to lose T or be destroyed
+		template<Component T, typename F>
+		void on_remove(F&& func) {
+			add_hook<T>(register_component<std::remove_cvref_t<T>>(), ComponentHook::Remove, std::forward<F>(func));
+		}
+
+		//hook of any component whose values are Ts, e.g. of a pair
+		template<Component T, typename F>
+		void add_hook(const ComponentId component_id, const ComponentHook hook, F&& func) {
+			assert(m_component_manager.is_id_valid(component_id)
+				&& m_component_manager[component_id].layout() == utils::Layout::of<T>() && "The component's values aren't Ts");
+			m_hooks.add<T>(component_id, hook, std::forward<F>(func));
+		}
+
+		[[nodiscard]] const ComponentHooks& hooks() const noexcept { return m_hooks; }
+
+		//constructs the R resource from args, replacing the one there is, see Resources
+		template<typename R, typename ... Args> requires std::constructible_from<R, Args&&...>
+		R& insert_resource(Args&& ... args) {
+			return m_resources.insert<R>(std::forward<Args>(args)...);
+		}
+
+		//constructs the R resource from args unless there is one already
+		template<typename R, typename ... Args> requires std::constructible_from<R, Args&&...>
+		R& init_resource(Args&& ... args) {
+			if (auto* const resource = m_resources.get<R>()) {
+				return *resource;
+			}
+			return m_resources.insert<R>(std::forward<Args>(args)...);
+		}
+
+		//panics if there is no R resource
+		template<typename R>
+		[[nodiscard]] auto& resource(this auto& self) {
+			auto* const resource = self.m_resources.template get<R>();
+			if (!resource) {
+				utils::panic("Resource {} does not exist", utils::TypeName<R>::value);
+			}
+			return *resource;
+		}
+
+		//null if there is no R resource
+		template<typename R>
+		[[nodiscard]] auto* get_resource(this auto& self) noexcept {
+			return self.m_resources.template get<R>();
+		}
+
+		template<typename R>
+		[[nodiscard]] bool has_resource() const noexcept {
+			return m_resources.contains<R>();
+		}
+
+		template<typename R>
+		bool remove_resource() noexcept {
+			return m_resources.remove<R>();
+		}
+
+		//adds the Events<T> resource unless there is one, update_events advances it
+		//args are passed to the Events constructor, e.g. the pool of parallel senders
+		template<typename T, typename ... Args>
+		Events<T>& add_events(Args&& ... args) {
+			constexpr EventUpdateFn update = &update_events_of<T>;
+			if (!std::ranges::contains(m_event_updates, update)) {
+				m_event_updates.push_back(update);
+			}
+			return init_resource<Events<T>>(std::forward<Args>(args)...);
+		}
+
+		//starts a new frame in every Events resource added with add_events, e.g. once per schedule run
+		void update_events() {
+			for (const auto update : m_event_updates) {
+				update(m_resources);
+			}
+		}
+
+		//makes child the last child of parent and sets its ChildOf, see Hierarchy
+		//panics if one of them doesn't exist or parent is child or one of its descendants
+		void set_parent(const Entity child, const Entity parent) {
+			flush_entities();
+			for (const auto entity : { child, parent }) {
+				if (!m_entity_manager.is_valid(entity)) {
+					utils::panic("Entity {} does not exist", entity);
+				}
+			}
+
+			m_hierarchy.set_parent(child, parent);
+			add_components(child, ChildOf{ parent });
+		}
+
+		//makes child a root and removes its ChildOf, false if it has no parent
+		bool remove_parent(const Entity child) {
+			flush_entities();
+			if (!m_hierarchy.remove_parent(child)) {
+				return false;
+			}
+			remove_components<ChildOf>(child);
+			return true;
+		}
+
+		//rebuilds the hierarchy from the ChildOf components, e.g. after they were restored from a snapshot
+		void rebuild_hierarchy() {
+			std::vector<std::pair<Entity, Entity>> links;
+			const auto component_id = m_component_manager.component_id<ChildOf>();
+			const auto records = m_archetype_manager.component_index().find(component_id);
+			if (records != m_archetype_manager.component_index().end()) {
+				for (const auto archetype_id : records->second | std::views::keys) {
+					const auto& archetype = m_archetype_manager[archetype_id];
+					const auto& column = m_storage[archetype.table_id()][component_id];
+					for (const auto& archetype_entity : archetype.entities()) {
+						links.emplace_back(archetype_entity.entity, column.data().get<ChildOf>(archetype_entity.table_row.to_index())->parent);
+					}
+				}
+			}
+			m_hierarchy.rebuild(links);
 		}
 
 		template<Bundle B>
@@ -123,21 +421,513 @@ namespace glaze::ecs {
 			return { register_component<Cs>()... };
 		}
 
+		//makes dst an exact copy of this world, e.g. to roll back to or to simulate ahead speculatively
+		//dst keeps its allocations, tables and archetypes it already has with the same components are refilled in place
+		//components are copied with memcpy if they're trivially copyable and with their copy constructor otherwise
+		//dst must have registered its components in the same order as this world, a fresh world or an earlier clone always has
+		//resources aren't copied, dst keeps its own
+		void clone_into(World& dst) const {
+			assert(!m_entity_manager.needs_flush() && !dst.m_entity_manager.needs_flush() && "Reserved entities have to be flushed first");
+
+			for (const auto& meta : m_component_manager.components()) {
+				const auto dst_id = meta.is_pair()
+					? dst.m_component_manager.copy_pair(meta)
+					: dst.m_component_manager.register_component(*m_component_manager.get_desc(meta.id()));
+				if (dst_id != meta.id()) {
+					utils::panic("Component {} has a different id in the destination world", meta.name());
+				}
+			}
+			dst.m_component_manager.copy_pairs_from(m_component_manager);
+
+			//ids are the same unless dst created its tables or archetypes in a different order
+			bool same_ids = true;
+			const auto& tables = m_storage.table_manager.tables();
+			std::vector<TableId> table_map(tables.size());
+			std::vector<bool> dst_tables_used(dst.m_storage.table_manager.size());
+			for (const auto& table : tables) {
+				const auto index = table.id().to_index();
+				auto dst_id = table.id();
+				if (index >= dst.m_storage.table_manager.size() || !std::ranges::equal(dst.m_storage[dst_id].components(), table.components())) {
+					const std::vector<ComponentId> components(table.components().begin(), table.components().end());
+					dst_id = dst.m_storage.table_manager.try_emplace(components, dst.m_component_manager);
+					dst_tables_used.resize(dst.m_storage.table_manager.size());
+					same_ids &= dst_id == table.id();
+				}
+				table_map[index] = dst_id;
+				dst_tables_used[dst_id.to_index()] = true;
+				dst.m_storage[dst_id].copy_from(table);
+			}
+			for (size_t i = 0; i < dst_tables_used.size(); ++i) {
+				if (!dst_tables_used[i]) {
+					dst.m_storage[TableId::from_index(i)].clear();
+				}
+			}
+
+			const auto& archetypes = m_archetype_manager.archetypes();
+			std::vector<ArchetypeId> archetype_map(archetypes.size());
+			std::vector<bool> dst_archetypes_used(dst.m_archetype_manager.size());
+			for (const auto& archetype : archetypes) {
+				const auto index = archetype.id().to_index();
+				auto dst_id = archetype.id();
+				const auto dst_table_id = table_map[archetype.table_id().to_index()];
+				//the table holds the table components, masks can't tell apart components past ComponentMask's bits
+				if (index >= dst.m_archetype_manager.size() || dst.m_archetype_manager[dst_id].table_id() != dst_table_id
+					|| !std::ranges::equal(dst.m_archetype_manager[dst_id].sparse_components(), archetype.sparse_components())) {
+					const auto table_components = archetype.table_components() | std::ranges::to<std::vector>();
+					const auto sparse_components = archetype.sparse_components() | std::ranges::to<std::vector>();
+					dst_id = dst.m_archetype_manager.try_emplace(table_components, sparse_components, dst.m_component_manager, dst.m_storage.table_manager);
+					dst_archetypes_used.resize(dst.m_archetype_manager.size());
+					same_ids &= dst_id == archetype.id();
+				}
+				archetype_map[index] = dst_id;
+				dst_archetypes_used[dst_id.to_index()] = true;
+				dst.m_archetype_manager[dst_id].copy_entities_from(archetype);
+			}
+			for (size_t i = 0; i < dst_archetypes_used.size(); ++i) {
+				if (!dst_archetypes_used[i]) {
+					dst.m_archetype_manager[ArchetypeId::from_index(i)].clear_entities();
+				}
+			}
+
+			for (auto&& [component_id, sparse_set] : dst.m_storage.sparse_sets.iter()) {
+				if (!m_storage.sparse_sets.contains(component_id)) {
+					sparse_set.clear();
+				}
+			}
+			for (const auto& [component_id, sparse_set] : m_storage.sparse_sets.iter()) {
+				dst.m_storage.ensure_component(m_component_manager[component_id]);
+				dst.m_storage[component_id].copy_from(sparse_set);
+			}
+
+			dst.m_entity_manager.copy_from(m_entity_manager);
+			if (!same_ids) {
+				for (const auto& archetype : archetypes) {
+					const auto archetype_id = archetype_map[archetype.id().to_index()];
+					const auto table_id = table_map[archetype.table_id().to_index()];
+					for (const auto [row, archetype_entity] : archetype.entities() | std::views::enumerate) {
+						dst.m_entity_manager.set_location(archetype_entity.entity, EntityLocation{
+							.archetype_id = archetype_id,
+							.archetype_row = ArchetypeRow::from_index(static_cast<size_t>(row)),
+							.table_id = table_id,
+							.table_row = archetype_entity.table_row
+						});
+					}
+				}
+			}
+
+			dst.m_hierarchy.copy_from(m_hierarchy);
+			dst.m_change_tick = m_change_tick;
+			dst.m_last_tick_check = m_last_tick_check;
+		}
+
 		[[nodiscard]] WorldId world_id() const noexcept { return m_id; }
 
+		//tick component writes are stamped with
+		[[nodiscard]] Tick change_tick() const noexcept { return m_change_tick.get(); }
+
+		//returns the current tick for a query run and advances the world, so writes after the run are newer than it
+		//safe to call from queries running in parallel systems
+		Tick increment_change_tick() noexcept {
+			return m_change_tick.increment();
+		}
+
+		//clamps component ticks and watermarks too old to be compared safely, see Tick::clamp
+		//only does a pass once the tick advanced CHECK_TICK_INTERVAL since the last one, true if it did
+		//queries and recorders kept outside a Schedule have to clamp their ticks after a pass
+		//must not overlap with queries, Schedule runs it before its systems
+		bool check_change_ticks() noexcept {
+			const auto this_run = m_change_tick.get();
+			if (this_run.get() - m_last_tick_check.get() < Tick::CHECK_TICK_INTERVAL) {
+				return false;
+			}
+
+			for (size_t i = 0; i < m_storage.table_manager.size(); ++i) {
+				auto& table = m_storage[TableId::from_index(i)];
+				for (const auto component_id : table.components()) {
+					table[component_id].check_ticks(this_run);
+				}
+			}
+			for (auto&& [component_id, sparse_set] : m_storage.sparse_sets.iter()) {
+				sparse_set.check_ticks(this_run);
+			}
+			m_last_tick_check = this_run;
+			return true;
+		}
+
 		[[nodiscard]] auto& entity_manager(this auto& self) noexcept { return self.m_entity_manager; }
 		[[nodiscard]] auto& component_manager(this auto& self) noexcept { return self.m_component_manager; }
 		[[nodiscard]] auto& archetype_manager(this auto& self) noexcept { return self.m_archetype_manager; }
 		[[nodiscard]] auto& bundle_manager(this auto& self) noexcept { return self.m_bundle_manager; }
 		[[nodiscard]] auto& storage(this auto& self) noexcept { return self.m_storage; }
+		[[nodiscard]] auto& resources(this auto& self) noexcept { return self.m_resources; }
+		[[nodiscard]] const Hierarchy& hierarchy() const noexcept { return m_hierarchy; }
 
 	private:
+		//places the moved entities of a delta again without the cascades of destroy_entities, see remove_entities
+		friend bool apply_delta(World& world, std::span<const std::byte> bytes);
+
+		using EventUpdateFn = void(*)(Resources& resources);
+
+		template<typename T>
+		static void update_events_of(Resources& resources) {
+			if (auto* const events = resources.get<Events<T>>()) {
+				events->update();
+			}
+		}
+
+		//components of the bundle the entity doesn't have are ignored, false if it has none of them
+		bool remove_bundle(const Entity entity, const BundleId bundle_id) {
+			const auto location = m_entity_manager.get_location(entity);
+			if (!location) {
+				return false;
+			}
+
+			const auto transition = m_archetype_manager.remove_bundle_from_archetype(
+				location->archetype_id,
+				bundle_id,
+				m_bundle_manager,
+				m_component_manager,
+				m_storage.table_manager);
+
+			if (transition.archetype_id == location->archetype_id) {
+				return false;
+			}
+
+			invoke_remove_hooks(*location, m_bundle_manager[bundle_id].components());
+
+			//dropped table columns are destroyed by the table move, sparse ones have to go first
+			const auto& archetype = m_archetype_manager[location->archetype_id];
+			for (const auto component_id : m_bundle_manager[bundle_id].sparse_components()) {
+				if (archetype.has_component(component_id)) {
+					m_storage[component_id].remove_and_destroy_untyped(entity);
+				}
+			}
+
+			move_entity(entity, *location, transition);
+			return true;
+		}
+
+		//invokes the hook of the component for the sorted rows of the table in runs that are contiguous in the table and in the component's storage
+		template<std::ranges::random_access_range Rows>
+		void invoke_hooks(const ComponentHook hook, const ComponentId component_id, const Table& table, const Rows& rows) const {
+			if (!m_hooks.contains(component_id, hook)) {
+				return;
+			}
+
+			const auto column = table.at(component_id);
+			const auto& data = column ? column->get().data() : m_storage[component_id].data();
+			const auto value_row = [&](const size_t row) {
+				return column ? row : m_storage[component_id].dense_row(table.entity(row).index())->to_index();
+			};
+
+			const size_t chunk_rows = table.chunk_rows();
+			const size_t size = std::ranges::size(rows);
+			for (size_t i = 0; i < size;) {
+				const size_t first = rows[i];
+				const size_t first_value = value_row(first);
+				size_t length = 1;
+				while (i + length < size && static_cast<size_t>(rows[i + length]) == first + length
+					&& (chunk_rows == 0 || (first + length) % chunk_rows != 0)
+					&& value_row(first + length) == first_value + length) {
+					++length;
+				}
+
+				m_hooks.invoke(hook, { component_id, table.entities({ first, length }), data.get(first_value) });
+				i += length;
+			}
+		}
+
+		//add hooks of the components the entity didn't have in its old archetype, replace hooks of the others
+		void invoke_add_hooks(const ArchetypeId old_archetype_id, const EntityLocation& location, const std::span<const ComponentId> components) const {
+			if (m_hooks.empty()) {
+				return;
+			}
+
+			const auto& old_archetype = m_archetype_manager[old_archetype_id];
+			const size_t row = location.table_row.to_index();
+			for (const auto component_id : components) {
+				const auto hook = old_archetype.has_component(component_id) ? ComponentHook::Replace : ComponentHook::Add;
+				invoke_hooks(hook, component_id, m_storage[location.table_id], std::span(&row, 1));
+			}
+		}
+
+		//remove hooks of the components the entity has
+		void invoke_remove_hooks(const EntityLocation& location, const std::span<const ComponentId> components) const {
+			if (m_hooks.empty()) {
+				return;
+			}
+
+			const auto& archetype = m_archetype_manager[location.archetype_id];
+			const size_t row = location.table_row.to_index();
+			for (const auto component_id : components) {
+				if (archetype.has_component(component_id)) {
+					invoke_hooks(ComponentHook::Remove, component_id, m_storage[location.table_id], std::span(&row, 1));
+				}
+			}
+		}
+
+		//add hooks of the bundle's components for the entities spawned into the target since first_row
+		template<typename Target>
+		void invoke_spawn_hooks(const Target& target, const size_t first_row) const {
+			if (m_hooks.empty()) {
+				return;
+			}
+
+			const auto rows = std::views::iota(first_row, target.table->entity_count());
+			for (const auto component_id : target.bundle_meta->components()) {
+				invoke_hooks(ComponentHook::Add, component_id, *target.table, rows);
+			}
+		}
+
+		//takes the entities out of their archetypes, tables and sparse sets, every archetype and table is compacted in a single pass
+		//their slots stay alive and the hierarchy and pairs aren't touched, entities without a location are skipped
+		//remove hooks run before anything is removed, returns the removed entities in the order they were given
+		std::vector<Entity> remove_entities(const std::span<const Entity> entities, const bool hooks) {
+			struct Removed {
+				Entity entity;
+				EntityLocation location;
+				//position in entities
+				size_t order;
+			};
+
+			std::vector<Removed> locations;
+			locations.reserve(entities.size());
+			for (size_t i = 0; i < entities.size(); ++i) {
+				if (const auto location = m_entity_manager.get_location(entities[i])) {
+					locations.push_back({ entities[i], *location, i });
+				}
+			}
+
+			std::vector<size_t> rows;
+			std::vector<size_t> table_rows;
+			const auto sort_by = [&](auto key, auto row) {
+				std::ranges::sort(locations, [&](const Removed& a, const Removed& b) {
+					return std::tuple{ key(a), row(a), a.order } < std::tuple{ key(b), row(b), b.order };
+				});
+			};
+			const auto for_each_group = [&](auto key, auto row, auto&& remove) {
+				sort_by(key, row);
+				for (auto first = locations.begin(); first != locations.end();) {
+					const auto last = std::find_if(first, locations.end(), [&](const Removed& d) { return key(d) != key(*first); });
+					rows.clear();
+					for (auto it = first; it != last; ++it) {
+						rows.push_back(row(*it));
+					}
+					remove(*first, std::span<const Removed>(first, last));
+					first = last;
+				}
+			};
+			const auto archetype_key = [](const Removed& d) { return d.location.archetype_id.get(); };
+			const auto archetype_row = [](const Removed& d) { return d.location.archetype_row.to_index(); };
+
+			//duplicates end up next to each other, the first one is kept
+			sort_by(archetype_key, archetype_row);
+			const auto duplicates = std::ranges::unique(locations, {}, &Removed::entity);
+			locations.erase(duplicates.begin(), duplicates.end());
+
+			//the entities are still where they were when their hooks run
+			if (hooks && !m_hooks.empty()) {
+				for_each_group(archetype_key, archetype_row, [&](const Removed& group, const std::span<const Removed> group_entities) {
+					const auto& archetype = m_archetype_manager[group.location.archetype_id];
+					table_rows.clear();
+					for (const auto& d : group_entities) {
+						table_rows.push_back(d.location.table_row.to_index());
+					}
+					std::ranges::sort(table_rows);
+					for (const auto component_id : archetype.components()) {
+						invoke_hooks(ComponentHook::Remove, component_id, m_storage[archetype.table_id()], table_rows);
+					}
+				});
+			}
+
+			for (const auto& d : locations) {
+				m_entity_manager.set_location(d.entity, NULL_ENTITY_LOCATION);
+			}
+
+			for_each_group(archetype_key, archetype_row, [&](const Removed& group, const std::span<const Removed> group_entities) {
+				auto& archetype = m_archetype_manager[group.location.archetype_id];
+				for (const auto component_id : archetype.sparse_components()) {
+					auto& sparse_set = m_storage[component_id];
+					for (const auto& d : group_entities) {
+						sparse_set.remove_and_destroy_untyped(d.entity);
+					}
+				}
+
+				archetype.remove_entities(rows, [&](const Entity moved, const ArchetypeRow row) {
+					m_entity_manager.update_archetype_location(moved, row);
+				});
+			});
+
+			for_each_group(
+				[](const Removed& d) { return d.location.table_id.get(); },
+				[](const Removed& d) { return d.location.table_row.to_index(); },
+				[&](const Removed& group, std::span<const Removed>) {
+					m_storage[group.location.table_id].remove_entities(rows, [&](const Entity moved, const TableRow row) {
+						update_moved_table_row(moved, row);
+					});
+				});
+
+			std::ranges::sort(locations, {}, &Removed::order);
+			return locations | std::views::transform(&Removed::entity) | std::ranges::to<std::vector>();
+		}
+
+		[[nodiscard]] BundleId pair_bundle(const ComponentId pair_id) {
+			return m_bundle_manager.register_bundle(std::span(&pair_id, 1), m_component_manager, m_storage);
+		}
+
+		//func is invoked with (const Archetype&, const ArchetypeEntity&) for every entity with the component
+		template<typename F>
+		void for_each_with_component(const ComponentId component_id, F&& func) const {
+			const auto records = m_archetype_manager.component_index().find(component_id);
+			if (records == m_archetype_manager.component_index().end()) {
+				return;
+			}
+			for (const auto archetype_id : records->second | std::views::keys) {
+				const auto& archetype = m_archetype_manager[archetype_id];
+				for (const auto& archetype_entity : archetype.entities()) {
+					func(archetype, archetype_entity);
+				}
+			}
+		}
+
+		//pairs targeting a destroyed entity would never match anything again, they're removed and their ids released
+		void remove_pairs_targeting(const Entity target) {
+			if (!m_component_manager.has_pairs()) {
+				return;
+			}
+
+			std::vector<Entity> sources;
+			for (const auto pair_id : m_component_manager.target_pairs(target)) {
+				sources.clear();
+				for_each_with_component(pair_id, [&](const Archetype&, const ArchetypeEntity& archetype_entity) {
+					sources.push_back(archetype_entity.entity);
+				});
+
+				const auto bundle_id = pair_bundle(pair_id);
+				for (const auto source : sources) {
+					remove_bundle(source, bundle_id);
+				}
+				//the id will mean another pair
+				m_hooks.remove(pair_id);
+			}
+			m_component_manager.release_pairs(target);
+		}
+
+		//children of the entity become roots, so it can be destroyed
+		void remove_from_hierarchy(const Entity entity) {
+			if (m_hierarchy.empty() || !m_hierarchy.contains(entity)) {
+				return;
+			}
+
+			for (auto children = m_hierarchy.children(entity); !children.empty(); children = m_hierarchy.children(entity)) {
+				remove_parent(*children.begin());
+			}
+			m_hierarchy.remove(entity);
+		}
+
+		//moves the entity into the transition's archetype and table, the column map makes the table move lookup free
+		EntityLocation move_entity(const Entity entity, const EntityLocation& location, const ArchetypeTransition& transition) {
+			if (transition.archetype_id == location.archetype_id) {
+				return location;
+			}
+
+			auto& archetype = m_archetype_manager[location.archetype_id];
+			const auto [moved_entity_in_archetype, table_row] = archetype.remove_entity(location.archetype_row);
+			if (moved_entity_in_archetype) {
+				m_entity_manager.update_archetype_location(*moved_entity_in_archetype, location.archetype_row);
+			}
+
+			auto new_table_row = table_row;
+			if (transition.table_id != location.table_id) {
+				auto& table = m_storage[location.table_id];
+				const auto [moved_entity_in_table, moved_table_row] = table.move_to(m_storage[transition.table_id], table_row, transition.columns);
+				if (moved_entity_in_table) {
+					update_moved_table_row(*moved_entity_in_table, table_row);
+				}
+				new_table_row = moved_table_row;
+			}
+
+			const auto new_location = m_archetype_manager[transition.archetype_id].add_entity(entity, new_table_row);
+			m_entity_manager.set_location(entity, new_location);
+			return new_location;
+		}
+
+		template<typename Targets>
+		struct SpawnTarget {
+			Archetype* archetype;
+			Table* table;
+			const BundleMeta* bundle_meta;
+			Targets targets;
+		};
+
+		//resolves where entities with the bundle are spawned and reserves room for count of them
+		template<Bundle B>
+		auto spawn_target(const size_t count) {
+			flush_entities();
+			const auto bundle_id = register_bundle<B>();
+			const auto transition = m_archetype_manager.add_bundle_to_archetype(
+				EMPTY_ARCHETYPE_ID,
+				bundle_id,
+				m_bundle_manager,
+				m_component_manager,
+				m_storage.table_manager);
+
+			auto& archetype = m_archetype_manager[transition.archetype_id];
+			auto& table = m_storage[transition.table_id];
+			const auto& bundle_meta = m_bundle_manager[bundle_id];
+
+			if (count > 0) {
+				m_entity_manager.reserve(count);
+				archetype.reserve(count);
+				table.reserve(count);
+				for (const auto component_id : bundle_meta.sparse_components()) {
+					m_storage[component_id].reserve(count);
+				}
+			}
+
+			return SpawnTarget{ &archetype, &table, &bundle_meta, m_storage.bundle_targets<B>(transition.table_id, bundle_meta) };
+		}
+
+		template<typename Target, Bundle B>
+		Entity spawn_into(Target& target, B&& bundle) {
+			const auto entity = m_entity_manager.create_entity();
+			const auto table_row = target.table->add_entity(entity);
+			m_entity_manager.set_location(entity, target.archetype->add_entity(entity, table_row));
+			Storage::write_bundle(std::forward<B>(bundle), entity, table_row, target.targets, m_change_tick.get());
+			return entity;
+		}
+
+		void add_to_empty_archetype(const Entity entity) {
+			auto& table = m_storage.empty_table();
+			const auto table_row = table.add_entity(entity);
+
+			auto& archetype = m_archetype_manager.empty_archetype();
+			const auto location = archetype.add_entity(entity, table_row);
+
+			m_entity_manager.set_location(entity, location);
+		}
+
+		//entity swapped into a freed table row
+		void update_moved_table_row(const Entity moved_entity, const TableRow table_row) noexcept {
+			const auto moved_location = *m_entity_manager.get_location(moved_entity);
+			m_entity_manager.update_table_location(moved_entity, table_row);
+
+			auto& moved_entity_archetype = m_archetype_manager[moved_location.archetype_id];
+			moved_entity_archetype.set_entity_table_row(moved_location.archetype_row, table_row);
+		}
+
 		WorldId m_id{0};
+		TickCounter m_change_tick{ Tick{1} };
+		Tick m_last_tick_check{1};
 
 		EntityManager m_entity_manager;
 		ComponentManager m_component_manager;
 		ArchetypeManager m_archetype_manager;
 		BundleManager m_bundle_manager;
 		Storage m_storage;
+		Hierarchy m_hierarchy;
+		ComponentHooks m_hooks;
+		Resources m_resources;
+		std::vector<EventUpdateFn> m_event_updates;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstdint>
+
+#include "ECS/World.h"
+
+namespace glaze::ecs::tests {
+	//resource used from test_Resources.cpp and test_ResourcesUnit.cpp, where it gets different TypeIndex values
+	struct SharedResource {
+		int value = 0;
+	};
+
+	//defined in test_ResourcesUnit.cpp
+	SharedResource& insert_shared_resource(World& world, int value);
+	SharedResource* get_shared_resource(World& world);
+	uint64_t shared_resource_index();
+}
\ No newline at end of file
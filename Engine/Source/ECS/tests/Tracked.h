@@ -0,0 +1,18 @@
+#pragma once
+
+namespace glaze::ecs::tests {
+	//counts live instances to catch leaked or double destroyed values, reset alive before every test using it
+	struct Tracked {
+		static inline int alive = 0;
+
+		int value = 0;
+
+		Tracked() noexcept { ++alive; }
+		explicit Tracked(const int v) noexcept : value(v) { ++alive; }
+		Tracked(const Tracked& other) noexcept : value(other.value) { ++alive; }
+		Tracked(Tracked&& other) noexcept : value(other.value) { ++alive; }
+		Tracked& operator=(const Tracked& other) noexcept = default;
+		Tracked& operator=(Tracked&& other) noexcept = default;
+		~Tracked() { --alive; }
+	};
+}
\ No newline at end of file
@@ -0,0 +1,175 @@
+#include <gtest/gtest.h>
+
+#include "ECS/Command/ParallelCommands.h"
+#include "ECS/Query/Query.h"
+#include "Tracked.h"
+
+namespace glaze::ecs::tests {
+	struct CommandPosition {
+		float x = 0.0f;
+		float y = 0.0f;
+	};
+
+	struct CommandVelocity {
+		float x = 0.0f;
+		float y = 0.0f;
+	};
+
+	struct CommandHealth {
+		static constexpr auto STORAGE_TYPE = StorageType::SparseSet;
+		int value = 0;
+	};
+
+	struct CommandsTest : testing::Test {
+	protected:
+		void SetUp() override { Tracked::alive = 0; }
+
+		template<typename ... Ts>
+		size_t count() {
+			size_t n = 0;
+			Query<Ts...>{world}.for_each(world, [&](const Entity, const Ts&...) { ++n; });
+			return n;
+		}
+
+		World world;
+	};
+
+	TEST_F(CommandsTest, AppliesRecordedChanges) {
+		const auto a = world.create_entity(CommandPosition{1.0f, 0.0f});
+		const auto b = world.create_entity(CommandPosition{2.0f, 0.0f});
+		const auto c = world.create_entity(CommandPosition{3.0f, 0.0f}, CommandHealth{3});
+
+		Commands commands;
+		commands.spawn(CommandPosition{}, CommandVelocity{});
+		commands.spawn(CommandPosition{}, CommandVelocity{});
+		commands.add_components(a, CommandVelocity{5.0f, 0.0f}, CommandHealth{1});
+		commands.remove_components<CommandHealth>(c);
+		commands.despawn(b);
+		EXPECT_EQ(commands.size(), 5);
+
+		//nothing changes until the buffer is applied
+		EXPECT_EQ(count<CommandPosition>(), 3);
+		EXPECT_EQ(count<CommandVelocity>(), 0);
+
+		commands.apply(world);
+		EXPECT_TRUE(commands.empty());
+
+		EXPECT_EQ(count<CommandPosition>(), 4);
+		EXPECT_EQ(count<CommandVelocity>(), 3);
+		EXPECT_EQ(count<CommandHealth>(), 1);
+		EXPECT_FALSE(world.entity_manager().is_valid(b));
+
+		float velocity = 0.0f;
+		Query<const CommandVelocity, const CommandHealth>{world}.for_each(world, [&](const Entity entity, const CommandVelocity& v, const CommandHealth& h) {
+			EXPECT_EQ(entity.to_id(), a.to_id());
+			EXPECT_EQ(h.value, 1);
+			velocity = v.x;
+		});
+		EXPECT_FLOAT_EQ(velocity, 5.0f);
+	}
+
+	TEST_F(CommandsTest, KeepsOrderForOneEntity) {
+		const auto entity = world.create_entity(CommandPosition{});
+
+		Commands commands;
+		commands.add_components(entity, CommandHealth{1});
+		commands.add_components(entity, CommandHealth{2});
+		commands.remove_components<CommandPosition>(entity);
+		commands.add_components(entity, CommandVelocity{});
+		commands.despawn(entity);
+		commands.add_components(entity, CommandHealth{3});
+		commands.push_fn([&](World& w) {
+			EXPECT_FALSE(w.entity_manager().is_valid(entity));
+		});
+		commands.apply(world);
+
+		EXPECT_EQ(world.entity_manager().size(), 0);
+		EXPECT_EQ(count<CommandHealth>(), 0);
+	}
+
+	TEST_F(CommandsTest, ClearDropsCommands) {
+		{
+			Commands commands;
+			commands.spawn(Tracked{1});
+			commands.add_components(world.create_entity(), Tracked{2});
+			EXPECT_EQ(Tracked::alive, 2);
+
+			commands.clear();
+			EXPECT_EQ(Tracked::alive, 0);
+
+			commands.spawn(Tracked{3});
+		}
+		EXPECT_EQ(Tracked::alive, 0);
+	}
+
+	TEST_F(CommandsTest, GrowsPastOneBlock) {
+		Commands commands;
+		for (int i = 0; i < 5000; ++i) {
+			commands.spawn(CommandPosition{static_cast<float>(i), 0.0f}, Tracked{i});
+		}
+		commands.apply(world);
+		EXPECT_EQ(Tracked::alive, 5000);
+
+		int sum = 0;
+		Query<const CommandPosition, const Tracked>{world}.for_each(world, [&](const CommandPosition& position, const Tracked& tracked) {
+			EXPECT_EQ(static_cast<int>(position.x), tracked.value);
+			sum += tracked.value;
+		});
+		EXPECT_EQ(sum, 4999 * 5000 / 2);
+
+		//the blocks are reused
+		commands.spawn(CommandPosition{});
+		commands.apply(world);
+		EXPECT_EQ(count<CommandPosition>(), 5001);
+	}
+
+	TEST_F(CommandsTest, AppliesCommandsRecordedWhileApplying) {
+		Commands commands;
+		std::vector<int> order;
+		commands.push_fn([&](World&) {
+			order.push_back(1);
+			//enough records to need blocks of their own
+			for (int i = 0; i < 5000; ++i) {
+				commands.spawn(Tracked{i});
+			}
+			commands.push_fn([&](World&) { order.push_back(3); });
+		});
+		commands.push_fn([&](World&) { order.push_back(2); });
+		commands.apply(world);
+
+		EXPECT_TRUE(commands.empty());
+		EXPECT_EQ(order, (std::vector{1, 2, 3}));
+		EXPECT_EQ(count<Tracked>(), 5000);
+		EXPECT_EQ(Tracked::alive, 5000);
+	}
+
+	TEST_F(CommandsTest, RecordsFromParallelIteration) {
+		static constexpr int COUNT = 4096;
+		for (int i = 0; i < COUNT; ++i) {
+			world.create_entity(CommandPosition{static_cast<float>(i), 0.0f});
+		}
+
+		utils::ThreadPool pool{4};
+		ParallelCommands commands{pool};
+
+		Query<const CommandPosition> positions{world};
+		positions.par_for_each(world, pool, [&](const Entity entity, const CommandPosition& position) {
+			auto& local = commands.local();
+			if (static_cast<int>(position.x) % 2 == 0) {
+				local.despawn(entity);
+			} else {
+				local.add_components(entity, CommandVelocity{1.0f, 0.0f});
+				local.spawn(CommandHealth{1});
+			}
+		}, 64);
+
+		EXPECT_EQ(commands.size(), COUNT + COUNT / 2);
+		commands.apply(world);
+		EXPECT_TRUE(commands.empty());
+
+		EXPECT_EQ(count<CommandPosition>(), COUNT / 2);
+		EXPECT_EQ(count<CommandVelocity>(), COUNT / 2);
+		EXPECT_EQ(count<CommandHealth>(), COUNT / 2);
+		EXPECT_EQ(world.entity_manager().size(), COUNT);
+	}
+}
@@ -0,0 +1,167 @@
+#include <gtest/gtest.h>
+#include <map>
+
+#include "ECS/World.h"
+
+namespace glaze::ecs::tests {
+	struct HookPosition {
+		float x = 0.0f;
+	};
+
+	struct HookHealth {
+		static constexpr auto STORAGE_TYPE = StorageType::SparseSet;
+		int value = 0;
+	};
+
+	struct HookTag {};
+
+	struct HookBundle {
+		HookPosition position;
+		HookHealth health;
+
+		auto components() && { return std::forward_as_tuple(std::move(position), std::move(health)); }
+	};
+
+	//every entity and value a hook saw and the number of batches it was invoked with
+	template<typename T>
+	struct HookLog {
+		void record(const std::span<const Entity> entities, const std::span<const T> values) {
+			++batches;
+			for (size_t i = 0; i < entities.size(); ++i) {
+				if constexpr (std::is_empty_v<T>) {
+					EXPECT_TRUE(values.empty());
+					seen[entities[i]] = T{};
+				} else {
+					seen[entities[i]] = values[i];
+				}
+			}
+		}
+
+		auto hook() {
+			return [this](const std::span<const Entity> entities, const std::span<const T> values) { record(entities, values); };
+		}
+
+		std::map<Entity, T> seen;
+		size_t batches = 0;
+	};
+
+	TEST(ComponentHooksTest, SpawningInvokesAddHooksInBatches) {
+		World world;
+		HookLog<HookPosition> positions;
+		HookLog<HookHealth> health;
+		world.on_add<HookPosition>(positions.hook());
+		world.on_add<HookHealth>(health.hook());
+
+		const auto entities = world.spawn_n<HookBundle>(100, [](const size_t i) {
+			return HookBundle{ { static_cast<float>(i) }, { static_cast<int>(i) * 2 } };
+		});
+		EXPECT_EQ(positions.batches, 1);
+		EXPECT_EQ(health.batches, 1);
+		ASSERT_EQ(positions.seen.size(), 100);
+		ASSERT_EQ(health.seen.size(), 100);
+		for (size_t i = 0; i < entities.size(); ++i) {
+			EXPECT_EQ(positions.seen[entities[i]].x, static_cast<float>(i));
+			EXPECT_EQ(health.seen[entities[i]].value, static_cast<int>(i) * 2);
+		}
+
+		world.create_entity(HookPosition{ 7.0f });
+		EXPECT_EQ(positions.batches, 2);
+		EXPECT_EQ(health.batches, 1);
+	}
+
+	TEST(ComponentHooksTest, BatchesStayWithinChunks) {
+		World world;
+		world.storage().table_manager.set_chunk_bytes(256);
+		HookLog<HookPosition> positions;
+		world.on_add<HookPosition>(positions.hook());
+
+		const auto entities = world.spawn_n<HookBundle>(1000, [](const size_t i) {
+			return HookBundle{ { static_cast<float>(i) }, {} };
+		});
+		EXPECT_EQ(positions.seen.size(), 1000);
+		EXPECT_GT(positions.batches, 1);
+		for (size_t i = 0; i < entities.size(); ++i) {
+			EXPECT_EQ(positions.seen[entities[i]].x, static_cast<float>(i));
+		}
+	}
+
+	TEST(ComponentHooksTest, AddingAndRemovingInvokesHooks) {
+		World world;
+		HookLog<HookPosition> added;
+		HookLog<HookPosition> replaced;
+		HookLog<HookPosition> removed;
+		HookLog<HookTag> tags;
+		world.on_add<HookPosition>(added.hook());
+		world.on_replace<HookPosition>(replaced.hook());
+		world.on_remove<HookPosition>(removed.hook());
+		world.on_add<HookTag>(tags.hook());
+
+		const auto entity = world.create_entity();
+		world.add_components(entity, HookPosition{ 1.0f });
+		EXPECT_EQ(added.seen.at(entity).x, 1.0f);
+		EXPECT_TRUE(replaced.seen.empty());
+
+		world.add_components(entity, HookPosition{ 2.0f }, HookTag{});
+		EXPECT_EQ(added.batches, 1);
+		EXPECT_EQ(replaced.seen.at(entity).x, 2.0f);
+		EXPECT_TRUE(tags.seen.contains(entity));
+
+		//removes see the values that are about to go away
+		EXPECT_FALSE(world.remove_components<HookHealth>(entity));
+		EXPECT_TRUE(removed.seen.empty());
+		EXPECT_TRUE(world.remove_components<HookPosition>(entity));
+		EXPECT_EQ(removed.seen.at(entity).x, 2.0f);
+
+		const auto other = world.create_entity(HookPosition{ 3.0f }, HookHealth{ 3 });
+		world.destroy_entity(other);
+		EXPECT_EQ(removed.seen.at(other).x, 3.0f);
+		EXPECT_EQ(removed.batches, 2);
+	}
+
+	TEST(ComponentHooksTest, DestroyingManyInvokesRemoveHooksPerRun) {
+		World world;
+		HookLog<HookPosition> positions;
+		HookLog<HookHealth> health;
+		world.on_remove<HookPosition>(positions.hook());
+		world.on_remove<HookHealth>(health.hook());
+
+		const auto entities = world.spawn_n<HookBundle>(100, [](const size_t i) {
+			return HookBundle{ { static_cast<float>(i) }, { static_cast<int>(i) } };
+		});
+
+		//two runs of consecutive rows
+		std::vector<Entity> destroyed(entities.begin() + 10, entities.begin() + 30);
+		destroyed.insert(destroyed.end(), entities.begin() + 50, entities.begin() + 60);
+		EXPECT_EQ(world.destroy_entities(destroyed), destroyed.size());
+		EXPECT_EQ(positions.batches, 2);
+		EXPECT_EQ(health.batches, 2);
+		ASSERT_EQ(positions.seen.size(), destroyed.size());
+		for (const auto entity : destroyed) {
+			EXPECT_EQ(positions.seen.at(entity).x, static_cast<float>(health.seen.at(entity).value));
+		}
+	}
+
+	TEST(ComponentHooksTest, DestroyingInvokesRemoveHooksWhileEntitiesAreInPlace) {
+		World world;
+		HookLog<HookHealth> health;
+		world.on_remove<HookHealth>(health.hook());
+		size_t placed = 0;
+		world.on_remove<HookPosition>([&](const std::span<const Entity> entities, std::span<const HookPosition>) {
+			for (const auto entity : entities) {
+				placed += world.entity_manager().is_valid(entity) && world.entity_manager().get_location(entity).has_value();
+			}
+		});
+
+		const auto entities = world.spawn_n<HookBundle>(10, [](const size_t i) {
+			return HookBundle{ { static_cast<float>(i) }, { static_cast<int>(i) } };
+		});
+		world.destroy_entity(entities[0]);
+		EXPECT_EQ(placed, 1);
+
+		//duplicates are destroyed once
+		EXPECT_EQ(world.destroy_entities(std::vector{ entities[3], entities[5], entities[3] }), 2);
+		EXPECT_EQ(placed, 3);
+		EXPECT_EQ(health.seen.size(), 3);
+		EXPECT_EQ(health.seen.at(entities[5]).value, 5);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,48 @@
+#include <gtest/gtest.h>
+
+#include "ECS/Component/ComponentMask.h"
+
+namespace glaze::ecs::tests {
+	TEST(ComponentMaskTest, SetAndTest) {
+		ComponentMask mask;
+		EXPECT_TRUE(mask.none());
+
+		EXPECT_TRUE(mask.set(ComponentId::from_index(3)));
+		EXPECT_TRUE(mask.set(ComponentId::from_index(200)));
+		EXPECT_TRUE(mask.test(ComponentId::from_index(3)));
+		EXPECT_TRUE(mask.test(ComponentId::from_index(200)));
+		EXPECT_FALSE(mask.test(ComponentId::from_index(4)));
+		EXPECT_FALSE(mask.none());
+	}
+
+	TEST(ComponentMaskTest, IdsPastCapacityDontFit) {
+		ComponentMask mask;
+		const auto id = ComponentId::from_index(ComponentMask::CAPACITY);
+		EXPECT_FALSE(ComponentMask::fits(id));
+		EXPECT_FALSE(mask.set(id));
+		EXPECT_FALSE(mask.test(id));
+		EXPECT_TRUE(mask.none());
+	}
+
+	TEST(ComponentMaskTest, ContainsAllAndIntersects) {
+		ComponentMask signature;
+		signature.set(ComponentId::from_index(1));
+		signature.set(ComponentId::from_index(70));
+		signature.set(ComponentId::from_index(130));
+
+		ComponentMask required;
+		required.set(ComponentId::from_index(1));
+		required.set(ComponentId::from_index(130));
+		EXPECT_TRUE(signature.contains_all(required));
+		EXPECT_TRUE(signature.contains_all(ComponentMask{}));
+
+		required.set(ComponentId::from_index(2));
+		EXPECT_FALSE(signature.contains_all(required));
+
+		ComponentMask excluded;
+		excluded.set(ComponentId::from_index(71));
+		EXPECT_FALSE(signature.intersects(excluded));
+		excluded.set(ComponentId::from_index(70));
+		EXPECT_TRUE(signature.intersects(excluded));
+	}
+}
@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+
+#include "ECS/Event/Events.h"
+
+namespace glaze::ecs::tests {
+	struct DamageEvent {
+		uint32_t target = 0;
+		int amount = 0;
+	};
+
+	static std::vector<int> amounts(const EventSpans<DamageEvent>& spans) {
+		std::vector<int> out;
+		spans.for_each([&](const DamageEvent& event) { out.push_back(event.amount); });
+		return out;
+	}
+
+	TEST(EventsTest, ReadersKeepTheirOwnCursor) {
+		Events<DamageEvent> events;
+		EventCursor first;
+		events.send(DamageEvent{ 1, 10 });
+		events.emplace(2u, 20);
+		EXPECT_EQ(amounts(events.read(first)), (std::vector{ 10, 20 }));
+		EXPECT_TRUE(events.read(first).empty());
+
+		//a reader created now only sees events sent later
+		auto second = events.cursor();
+		const std::vector<DamageEvent> batch{ { 3, 30 }, { 4, 40 } };
+		events.send_batch(batch);
+		EXPECT_EQ(amounts(events.read(second)), (std::vector{ 30, 40 }));
+
+		events.update();
+		events.send(DamageEvent{ 5, 50 });
+		EXPECT_EQ(amounts(events.read(first)), (std::vector{ 30, 40, 50 }));
+		EXPECT_EQ(amounts(events.read(second)), (std::vector{ 50 }));
+		EXPECT_EQ(events.size(), 5);
+	}
+
+	TEST(EventsTest, EventsLiveForTwoUpdates) {
+		Events<DamageEvent> events;
+		EventCursor reader;
+		EventCursor late;
+		events.send(DamageEvent{ 0, 1 });
+		events.update();
+		events.send(DamageEvent{ 0, 2 });
+		events.update();
+		EXPECT_EQ(events.size(), 1);
+		events.send(DamageEvent{ 0, 3 });
+		EXPECT_EQ(amounts(events.read(reader)), (std::vector{ 2, 3 }));
+
+		//the first event was dropped before the late reader got to it
+		events.update();
+		events.update();
+		EXPECT_TRUE(events.empty());
+		EXPECT_TRUE(events.read(late).empty());
+		events.send(DamageEvent{ 0, 4 });
+		EXPECT_EQ(amounts(events.read(late)), (std::vector{ 4 }));
+		EXPECT_EQ(amounts(events.read(reader)), (std::vector{ 4 }));
+
+		events.clear();
+		EXPECT_TRUE(events.read(reader).empty());
+		events.send(DamageEvent{ 0, 5 });
+		EXPECT_EQ(amounts(events.read(reader)), (std::vector{ 5 }));
+	}
+
+	TEST(EventsTest, ParallelSendersAreMergedOnUpdate) {
+		utils::ThreadPool pool(3);
+		Events<DamageEvent> events{ pool };
+		EventCursor reader;
+
+		constexpr size_t COUNT = 10000;
+		pool.parallel_for(COUNT, 64, [&](const size_t begin, const size_t end) {
+			for (size_t i = begin; i < end; ++i) {
+				events.send_parallel(DamageEvent{ static_cast<uint32_t>(i), 1 });
+			}
+		});
+		events.send(DamageEvent{ COUNT, 1 });
+		EXPECT_EQ(events.read(reader).size(), 1);
+
+		events.update();
+		const auto spans = events.read(reader);
+		ASSERT_EQ(spans.size(), COUNT);
+		std::vector<bool> seen(COUNT);
+		spans.for_each([&](const DamageEvent& event) { seen[event.target] = true; });
+		EXPECT_TRUE(std::ranges::all_of(seen, std::identity{}));
+	}
+}
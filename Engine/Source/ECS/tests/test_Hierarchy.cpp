@@ -0,0 +1,213 @@
+#include <gtest/gtest.h>
+#include <map>
+
+#include "ECS/Query/Query.h"
+
+namespace glaze::ecs::tests {
+	struct HierarchyOffset {
+		int value = 0;
+	};
+
+	struct HierarchyTest : testing::Test {
+	protected:
+		//checks the depth first order against the parents and the ChildOf components
+		void expect_consistent() {
+			const auto nodes = world.hierarchy().nodes();
+			std::map<Entity, size_t> positions;
+			for (size_t i = 0; i < nodes.size(); ++i) {
+				positions[nodes[i].entity] = i;
+			}
+
+			for (size_t i = 0; i < nodes.size(); ++i) {
+				const auto& node = nodes[i];
+				size_t children_size = 0;
+				for (const auto child : world.hierarchy().children(node.entity)) {
+					EXPECT_EQ(world.hierarchy().parent(child), node.entity);
+					children_size += nodes[positions[child]].subtree_size;
+				}
+				EXPECT_EQ(node.subtree_size, children_size + 1);
+
+				if (node.parent.index().valid()) {
+					const auto parent = positions.at(node.parent);
+					EXPECT_LT(parent, i);
+					EXPECT_LT(i, parent + nodes[parent].subtree_size);
+					EXPECT_EQ(node.depth, nodes[parent].depth + 1);
+				} else {
+					EXPECT_EQ(node.depth, 0);
+					EXPECT_GT(node.subtree_size, 1);
+				}
+			}
+
+			size_t with_parent = 0;
+			Query<const ChildOf>{world}.for_each(world, [&](const Entity entity, const ChildOf& child_of) {
+				EXPECT_EQ(world.hierarchy().parent(entity), child_of.parent);
+				++with_parent;
+			});
+			EXPECT_EQ(with_parent, static_cast<size_t>(std::ranges::count_if(nodes, [](const HierarchyNode& node) { return node.parent.index().valid(); })));
+		}
+
+		std::vector<Entity> children(const Entity entity) const {
+			return world.hierarchy().children(entity) | std::ranges::to<std::vector>();
+		}
+
+		World world;
+	};
+
+	TEST_F(HierarchyTest, KeepsDepthFirstOrderWhileReparenting) {
+		std::vector<Entity> e;
+		for (int i = 0; i < 8; ++i) {
+			e.push_back(world.create_entity(HierarchyOffset{i}));
+		}
+
+		// 0 -> 1 -> 2, 0 -> 3, 4 -> 5
+		world.set_parent(e[1], e[0]);
+		world.set_parent(e[2], e[1]);
+		world.set_parent(e[3], e[0]);
+		world.set_parent(e[5], e[4]);
+		expect_consistent();
+		EXPECT_EQ(world.hierarchy().size(), 6);
+		EXPECT_EQ(children(e[0]), (std::vector{ e[1], e[3] }));
+		EXPECT_EQ(world.hierarchy().subtrees().size(), 2);
+
+		//a subtree moves into the tree of another root, a whole tree moves under an inner node
+		world.set_parent(e[1], e[5]);
+		expect_consistent();
+		EXPECT_EQ(world.hierarchy().subtree(e[4]).size(), 4);
+		EXPECT_EQ(world.hierarchy().subtree(e[0]).size(), 2);
+
+		world.set_parent(e[4], e[3]);
+		world.set_parent(e[6], e[2]);
+		expect_consistent();
+		EXPECT_EQ(world.hierarchy().subtrees().size(), 1);
+		EXPECT_EQ(world.hierarchy().subtree(e[6]).front().depth, 6);
+
+		//a child that moves away and back becomes the last child
+		world.set_parent(e[7], e[0]);
+		world.set_parent(e[3], e[7]);
+		world.set_parent(e[3], e[0]);
+		expect_consistent();
+		EXPECT_EQ(children(e[0]), (std::vector{ e[7], e[3] }));
+
+		EXPECT_TRUE(world.remove_parent(e[7]));
+		EXPECT_FALSE(world.remove_parent(e[7]));
+		EXPECT_FALSE(world.hierarchy().contains(e[7]));
+		expect_consistent();
+	}
+
+	TEST_F(HierarchyTest, DestroyingAParentMakesItsChildrenRoots) {
+		const auto root = world.create_entity();
+		const auto middle = world.create_entity();
+		const auto a = world.create_entity();
+		const auto b = world.create_entity();
+		world.set_parent(middle, root);
+		world.set_parent(a, middle);
+		world.set_parent(b, middle);
+
+		world.destroy_entity(middle);
+		expect_consistent();
+		EXPECT_TRUE(world.hierarchy().empty());
+		EXPECT_FALSE(world.hierarchy().parent(a).has_value());
+
+		world.set_parent(a, root);
+		world.set_parent(b, a);
+		const std::vector destroyed{ root, b };
+		EXPECT_EQ(world.destroy_entities(destroyed), 2);
+		expect_consistent();
+		EXPECT_TRUE(world.hierarchy().empty());
+	}
+
+	TEST_F(HierarchyTest, DestroyingAParentMovedByItsChildren) {
+		const auto root = world.create_entity(HierarchyOffset{1});
+		const auto a = world.create_entity(HierarchyOffset{2});
+		const auto b = world.create_entity(HierarchyOffset{3});
+		const auto middle = world.create_entity(HierarchyOffset{4});
+		world.set_parent(a, middle);
+		world.set_parent(b, middle);
+		//middle is the last row of the table it shares with its children, they move it when they lose their ChildOf
+		world.set_parent(middle, root);
+
+		EXPECT_TRUE(world.destroy_entity(middle));
+		expect_consistent();
+		EXPECT_TRUE(world.hierarchy().empty());
+
+		std::map<Entity, int> offsets;
+		Query<const HierarchyOffset>{world}.for_each(world, [&](const Entity entity, const HierarchyOffset& offset) {
+			offsets[entity] = offset.value;
+		});
+		EXPECT_EQ(offsets, (std::map<Entity, int>{ { root, 1 }, { a, 2 }, { b, 3 } }));
+	}
+
+	TEST_F(HierarchyTest, PropagatesValuesDownTheSubtrees) {
+		//a forest of chains and fans, every entity's value is the sum of the offsets on its path
+		std::vector<Entity> entities;
+		for (int i = 0; i < 2000; ++i) {
+			const auto entity = world.create_entity(HierarchyOffset{i});
+			if (i % 50 != 0) {
+				world.set_parent(entity, entities[i % 3 == 0 ? i - 1 : i - 1 - (i % 7 == 0)]);
+			}
+			entities.push_back(entity);
+		}
+		expect_consistent();
+
+		const auto offset = [&](const Entity entity) {
+			const auto location = *world.entity_manager().get_location(entity);
+			const auto component_id = world.component_manager().component_id<HierarchyOffset>();
+			return world.storage()[location.table_id][component_id].data().get<HierarchyOffset>(location.table_row.to_index())->value;
+		};
+
+		std::map<Entity, int> expected;
+		for (const auto entity : entities) {
+			const auto parent = world.hierarchy().parent(entity);
+			expected[entity] = offset(entity) + (parent ? expected.at(*parent) : 0);
+		}
+
+		std::map<Entity, int> serial;
+		world.hierarchy().propagate<int>([&](const HierarchyNode& node, const int* parent) {
+			const int value = offset(node.entity) + (parent ? *parent : 0);
+			serial[node.entity] = value;
+			return value;
+		});
+		EXPECT_EQ(serial, expected);
+
+		utils::ThreadPool pool(3);
+		std::vector<int> parallel(entities.size());
+		world.hierarchy().par_propagate<int>(pool, [&](const HierarchyNode& node, const int* parent) {
+			const int value = offset(node.entity) + (parent ? *parent : 0);
+			parallel[node.entity.index().to_index()] = value;
+			return value;
+		});
+		for (const auto entity : entities) {
+			EXPECT_EQ(parallel[entity.index().to_index()], expected.at(entity));
+		}
+	}
+
+	TEST_F(HierarchyTest, RebuildsFromChildOf) {
+		std::vector<Entity> entities;
+		for (int i = 0; i < 20; ++i) {
+			entities.push_back(world.create_entity());
+			if (i > 0 && i % 4 != 0) {
+				world.set_parent(entities[i], entities[i / 2]);
+			}
+		}
+
+		std::map<Entity, Entity> parents;
+		for (const auto& node : world.hierarchy().nodes()) {
+			if (node.parent.index().valid()) {
+				parents[node.entity] = node.parent;
+			}
+		}
+
+		World copy;
+		world.clone_into(copy);
+		EXPECT_TRUE(std::ranges::equal(copy.hierarchy().nodes(), world.hierarchy().nodes(), {}, &HierarchyNode::entity, &HierarchyNode::entity));
+
+		world.rebuild_hierarchy();
+		expect_consistent();
+		for (const auto& node : world.hierarchy().nodes()) {
+			if (node.parent.index().valid()) {
+				EXPECT_EQ(parents.at(node.entity), node.parent);
+			}
+		}
+		EXPECT_EQ(parents.size(), 15);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,471 @@
+#include <gtest/gtest.h>
+#include <atomic>
+
+#include "ECS/Query/Query.h"
+
+namespace glaze::ecs::tests {
+	struct QueryPosition {
+		float x = 0.0f;
+		float y = 0.0f;
+	};
+
+	struct QueryVelocity {
+		float x = 0.0f;
+		float y = 0.0f;
+	};
+
+	struct QueryHealth {
+		static constexpr auto STORAGE_TYPE = StorageType::SparseSet;
+		int value = 0;
+	};
+
+	struct QueryBurning {
+		static constexpr auto STORAGE_TYPE = StorageType::SparseSet;
+		int damage = 0;
+	};
+
+	struct QueryTag {};
+
+	struct QueryTest : testing::Test {
+	protected:
+		World world;
+	};
+
+	TEST_F(QueryTest, MatchesArchetypesWithAllComponents) {
+		world.create_entity(QueryPosition{}, QueryVelocity{});
+		world.create_entity(QueryPosition{});
+		world.create_entity(QueryVelocity{});
+
+		const Query<QueryPosition, QueryVelocity> query{world};
+		EXPECT_EQ(query.archetypes().size(), 1);
+		EXPECT_EQ(query.tables().size(), 1);
+		EXPECT_EQ(query.archetype_version(), world.archetype_manager().version());
+	}
+
+	TEST_F(QueryTest, MatchesNewArchetypesIncrementally) {
+		Query<QueryPosition> query{world};
+		EXPECT_TRUE(query.archetypes().empty());
+
+		world.create_entity(QueryPosition{});
+		world.create_entity(QueryPosition{}, QueryVelocity{});
+		world.create_entity(QueryVelocity{});
+		EXPECT_TRUE(query.archetypes().empty());
+
+		query.update_archetypes(world.archetype_manager());
+		EXPECT_EQ(query.archetypes().size(), 2);
+		EXPECT_EQ(query.archetype_version(), world.archetype_manager().version());
+
+		query.update_archetypes(world.archetype_manager());
+		EXPECT_EQ(query.archetypes().size(), 2);
+	}
+
+	TEST_F(QueryTest, ForEachWritesComponents) {
+		world.create_entity(QueryPosition{0.0f, 0.0f}, QueryVelocity{1.0f, 2.0f});
+		world.create_entity(QueryPosition{1.0f, 1.0f}, QueryVelocity{1.0f, 2.0f});
+		const auto still = world.create_entity(QueryPosition{5.0f, 5.0f});
+
+		Query<QueryPosition, const QueryVelocity> movement{world};
+		movement.for_each(world, [](QueryPosition& position, const QueryVelocity& velocity) {
+			position.x += velocity.x;
+			position.y += velocity.y;
+		});
+
+		Query<const QueryPosition> positions{world};
+		size_t count = 0;
+		float sum = 0.0f;
+		positions.for_each(world, [&](const Entity entity, const QueryPosition& position) {
+			++count;
+			if (entity.to_id() == still.to_id()) {
+				EXPECT_FLOAT_EQ(position.x, 5.0f);
+			} else {
+				sum += position.y;
+			}
+		});
+
+		EXPECT_EQ(count, 3);
+		EXPECT_FLOAT_EQ(sum, 5.0f);
+	}
+
+	TEST_F(QueryTest, ForEachFetchesSparseComponents) {
+		world.create_entity(QueryPosition{}, QueryHealth{10});
+		world.create_entity(QueryPosition{}, QueryHealth{20});
+		world.create_entity(QueryHealth{30});
+
+		Query<const QueryPosition, QueryHealth> query{world};
+		EXPECT_FALSE((Query<const QueryPosition, QueryHealth>::IS_DENSE));
+
+		int sum = 0;
+		query.for_each(world, [&](const QueryPosition&, QueryHealth& health) {
+			sum += health.value;
+		});
+		EXPECT_EQ(sum, 30);
+	}
+
+	TEST_F(QueryTest, ForEachChunkVisitsWholeTables) {
+		for (int i = 0; i < 100; ++i) {
+			world.create_entity(QueryPosition{static_cast<float>(i), 0.0f}, QueryVelocity{1.0f, 1.0f});
+		}
+		for (int i = 0; i < 10; ++i) {
+			world.create_entity(QueryPosition{}, QueryVelocity{1.0f, 1.0f}, QueryHealth{i});
+		}
+		world.create_entity(QueryPosition{});
+
+		Query<QueryPosition, const QueryVelocity> query{world};
+		EXPECT_EQ(query.tables().size(), 1);
+
+		size_t chunks = 0;
+		query.for_each_chunk(world, [&](const std::span<const Entity> entities, const std::span<QueryPosition> positions, const std::span<const QueryVelocity> velocities) {
+			++chunks;
+			EXPECT_EQ(entities.size(), 110);
+			EXPECT_EQ(positions.size(), entities.size());
+			EXPECT_EQ(velocities.size(), entities.size());
+			for (size_t i = 0; i < positions.size(); ++i) {
+				positions[i].y += velocities[i].y;
+			}
+		});
+		EXPECT_EQ(chunks, 1);
+
+		float sum = 0.0f;
+		Query<const QueryPosition> positions{world};
+		positions.for_each_chunk(world, [&](const std::span<const QueryPosition> chunk) {
+			for (const auto& position : chunk) {
+				sum += position.y;
+			}
+		});
+		EXPECT_FLOAT_EQ(sum, 110.0f);
+	}
+
+	TEST_F(QueryTest, ForEachChunkVisitsEveryChunkOfChunkedTables) {
+		world.storage().table_manager.set_chunk_bytes(1024);
+
+		static constexpr int COUNT = 1000;
+		std::vector<Entity> entities;
+		for (int i = 0; i < COUNT; ++i) {
+			entities.push_back(world.create_entity(QueryPosition{static_cast<float>(i), 0.0f}, QueryVelocity{1.0f, 1.0f}));
+		}
+		world.destroy_entity(entities[10]);
+		world.destroy_entity(entities[500]);
+
+		Query<QueryPosition, const QueryVelocity> query{world};
+		const auto& table = world.storage()[query.tables()[0]];
+		//entity, two components and their ticks take 40 bytes a row
+		EXPECT_EQ(table.chunk_rows(), 16);
+
+		size_t chunks = 0;
+		size_t rows = 0;
+		query.for_each_chunk(world, [&](const std::span<const Entity> chunk, const std::span<QueryPosition> positions, const std::span<const QueryVelocity> velocities) {
+			++chunks;
+			rows += chunk.size();
+			EXPECT_LE(chunk.size(), table.chunk_rows());
+			EXPECT_EQ(positions.size(), chunk.size());
+			for (size_t i = 0; i < positions.size(); ++i) {
+				positions[i].y += velocities[i].y;
+			}
+		});
+		EXPECT_EQ(chunks, (COUNT - 2 + 15) / 16);
+		EXPECT_EQ(rows, COUNT - 2);
+
+		utils::ThreadPool pool{3};
+		std::atomic<int> moved = 0;
+		Query<const QueryPosition> positions{world};
+		positions.par_for_each_chunk(world, pool, [&](const std::span<const Entity> chunk, const std::span<const QueryPosition> chunk_positions) {
+			EXPECT_LE(chunk.size(), table.chunk_rows());
+			for (const auto& position : chunk_positions) {
+				moved += static_cast<int>(position.y);
+			}
+		}, 8);
+		EXPECT_EQ(moved.load(), COUNT - 2);
+	}
+
+	TEST_F(QueryTest, ParForEachVisitsEveryEntityOnce) {
+		static constexpr int COUNT = 10000;
+		for (int i = 0; i < COUNT; ++i) {
+			world.create_entity(QueryPosition{static_cast<float>(i), 0.0f}, QueryVelocity{1.0f, 0.0f});
+		}
+		for (int i = 0; i < COUNT; ++i) {
+			world.create_entity(QueryPosition{}, QueryHealth{1});
+		}
+
+		utils::ThreadPool pool{4};
+
+		Query<QueryPosition, const QueryVelocity> movement{world};
+		movement.par_for_each(world, pool, [](QueryPosition& position, const QueryVelocity& velocity) {
+			position.y += velocity.x;
+		}, 64);
+
+		std::atomic<int> moved = 0;
+		Query<const QueryPosition> positions{world};
+		positions.par_for_each_chunk(world, pool, [&](const std::span<const QueryPosition> chunk) {
+			for (const auto& position : chunk) {
+				moved += static_cast<int>(position.y);
+			}
+		}, 64);
+		EXPECT_EQ(moved.load(), COUNT);
+
+		std::atomic<int> health = 0;
+		Query<const QueryHealth> healths{world};
+		healths.par_for_each(world, pool, [&](const Entity, const QueryHealth& h) {
+			health += h.value;
+		}, 64);
+		EXPECT_EQ(health.load(), COUNT);
+	}
+
+	TEST_F(QueryTest, WithAndWithoutFilters) {
+		world.create_entity(QueryPosition{1.0f, 0.0f}, QueryTag{});
+		world.create_entity(QueryPosition{2.0f, 0.0f}, QueryTag{}, QueryVelocity{});
+		world.create_entity(QueryPosition{4.0f, 0.0f});
+
+		float tagged = 0.0f;
+		Query<const QueryPosition, With<QueryTag>> with_tag{world};
+		with_tag.for_each(world, [&](const QueryPosition& position) { tagged += position.x; });
+		EXPECT_FLOAT_EQ(tagged, 3.0f);
+
+		float untagged = 0.0f;
+		Query<const QueryPosition, Without<QueryTag>> without_tag{world};
+		without_tag.for_each(world, [&](const QueryPosition& position) { untagged += position.x; });
+		EXPECT_FLOAT_EQ(untagged, 4.0f);
+
+		float either = 0.0f;
+		Query<const QueryPosition, Or<With<QueryVelocity>, Without<QueryTag>>> or_query{world};
+		or_query.for_each(world, [&](const QueryPosition& position) { either += position.x; });
+		EXPECT_FLOAT_EQ(either, 6.0f);
+	}
+
+	TEST_F(QueryTest, OptionalFetchesMissingComponentsAsNull) {
+		world.create_entity(QueryPosition{}, QueryVelocity{1.0f, 0.0f}, QueryHealth{5});
+		world.create_entity(QueryPosition{});
+
+		size_t with_velocity = 0;
+		size_t with_health = 0;
+		Query<const QueryPosition, Optional<const QueryVelocity>, Optional<QueryHealth>> query{world};
+		query.for_each(world, [&](const QueryPosition&, const QueryVelocity* velocity, QueryHealth* health) {
+			with_velocity += velocity != nullptr;
+			with_health += health != nullptr;
+		});
+		EXPECT_EQ(with_velocity, 1);
+		EXPECT_EQ(with_health, 1);
+
+		size_t chunk_velocities = 0;
+		Query<const QueryPosition, Optional<const QueryVelocity>> chunked{world};
+		chunked.for_each_chunk(world, [&](const std::span<const QueryPosition>, const std::span<const QueryVelocity> velocities) {
+			chunk_velocities += velocities.size();
+		});
+		EXPECT_EQ(chunk_velocities, 1);
+	}
+
+	TEST_F(QueryTest, MatchesThroughRarestComponent) {
+		Query<const QueryPosition, With<QueryHealth>> query{world};
+
+		world.create_entity(QueryPosition{}, QueryHealth{});
+		world.create_entity(QueryPosition{}, QueryVelocity{});
+		world.create_entity(QueryPosition{}, QueryTag{});
+		world.create_entity(QueryPosition{}, QueryVelocity{}, QueryTag{});
+		world.create_entity(QueryPosition{}, QueryVelocity{}, QueryHealth{});
+
+		query.update_archetypes(world.archetype_manager());
+		ASSERT_EQ(query.archetypes().size(), 2);
+		EXPECT_LT(query.archetypes()[0], query.archetypes()[1]);
+
+		Query<QueryPosition, With<QueryTag>, Without<QueryVelocity>> late{world};
+		EXPECT_EQ(late.archetypes().size(), 1);
+	}
+
+	TEST_F(QueryTest, MaskMatchingAgreesWithMatches) {
+		world.create_entity(QueryPosition{}, QueryTag{});
+		world.create_entity(QueryPosition{}, QueryVelocity{});
+		world.create_entity(QueryPosition{}, QueryVelocity{}, QueryHealth{});
+		world.create_entity(QueryVelocity{}, QueryTag{});
+
+		const Query<const QueryPosition, Without<QueryHealth>> query{world};
+		const auto& archetype_manager = world.archetype_manager();
+		size_t matched = 0;
+		for (const auto& archetype : archetype_manager.archetypes()) {
+			EXPECT_EQ(query.matches_mask(archetype.mask()), query.matches(archetype));
+			matched += query.matches(archetype);
+		}
+		EXPECT_EQ(query.archetypes().size(), matched);
+		EXPECT_EQ(matched, 2);
+	}
+
+	TEST_F(QueryTest, AddedSeesOnlyNewComponents) {
+		world.create_entity(QueryPosition{}, QueryHealth{});
+
+		Query<const QueryPosition, Added<QueryPosition>> added{world};
+		Query<const QueryHealth, Added<QueryHealth>> added_health{world};
+		size_t count = 0;
+		added.for_each(world, [&](const QueryPosition&) { ++count; });
+		EXPECT_EQ(count, 1);
+		added_health.for_each(world, [&](const QueryHealth&) { ++count; });
+		EXPECT_EQ(count, 2);
+
+		count = 0;
+		added.for_each(world, [&](const QueryPosition&) { ++count; });
+		EXPECT_EQ(count, 0);
+
+		world.create_entity(QueryPosition{}, QueryVelocity{});
+		added.for_each(world, [&](const QueryPosition&) { ++count; });
+		added_health.for_each(world, [&](const QueryHealth&) { ++count; });
+		EXPECT_EQ(count, 1);
+	}
+
+	TEST_F(QueryTest, ChangedSeesMutableAccess) {
+		for (int i = 0; i < 4; ++i) {
+			world.create_entity(QueryPosition{}, QueryVelocity{}, QueryHealth{i});
+		}
+
+		Query<const QueryPosition, Changed<QueryPosition>> changed{world};
+		Query<const QueryHealth, Changed<QueryHealth>> changed_health{world};
+		size_t count = 0;
+		changed.for_each(world, [&](const QueryPosition&) { ++count; });
+		changed_health.for_each(world, [&](const QueryHealth&) { ++count; });
+		EXPECT_EQ(count, 8);
+
+		//read only access doesn't mark anything
+		Query<const QueryPosition, const QueryHealth> reader{world};
+		reader.for_each(world, [](const QueryPosition&, const QueryHealth&) {});
+
+		count = 0;
+		changed.for_each(world, [&](const QueryPosition&) { ++count; });
+		changed_health.for_each(world, [&](const QueryHealth&) { ++count; });
+		EXPECT_EQ(count, 0);
+
+		Query<QueryPosition, QueryHealth> writer{world};
+		writer.for_each(world, [](QueryPosition& position, QueryHealth& health) {
+			if (health.value % 2 == 0) {
+				position.x += 1.0f;
+			}
+		});
+
+		changed.for_each(world, [&](const QueryPosition&) { ++count; });
+		changed_health.for_each(world, [&](const QueryHealth&) { ++count; });
+		EXPECT_EQ(count, 8);
+
+		//a query doesn't see its own writes
+		count = 0;
+		writer.for_each(world, [](QueryPosition&, QueryHealth&) {});
+		Query<QueryPosition, Changed<QueryPosition>> self_writer{world};
+		self_writer.for_each(world, [&](QueryPosition&) { ++count; });
+		EXPECT_EQ(count, 4);
+		self_writer.for_each(world, [&](QueryPosition&) { ++count; });
+		EXPECT_EQ(count, 4);
+	}
+
+	TEST_F(QueryTest, OrOfChangeFilters) {
+		world.create_entity(QueryPosition{}, QueryVelocity{});
+		world.create_entity(QueryPosition{});
+
+		Query<const QueryPosition, Or<Changed<QueryPosition>, Changed<QueryVelocity>>> query{world};
+		size_t count = 0;
+		query.for_each(world, [&](const QueryPosition&) { ++count; });
+		EXPECT_EQ(count, 2);
+
+		Query<QueryVelocity> velocities{world};
+		velocities.for_each(world, [](QueryVelocity&) {});
+
+		count = 0;
+		query.for_each(world, [&](const QueryPosition&) { ++count; });
+		EXPECT_EQ(count, 1);
+	}
+
+	TEST(TickTest, IsNewerThanWrapsAround) {
+		EXPECT_TRUE(Tick{5}.is_newer_than(Tick{4}, Tick{6}));
+		EXPECT_FALSE(Tick{4}.is_newer_than(Tick{4}, Tick{6}));
+		EXPECT_FALSE(Tick{3}.is_newer_than(Tick{4}, Tick{6}));
+		EXPECT_TRUE(Tick{1}.is_newer_than(Tick{UINT32_MAX - 1}, Tick{2}));
+		EXPECT_FALSE(Tick{UINT32_MAX - 2}.is_newer_than(Tick{UINT32_MAX - 1}, Tick{2}));
+	}
+
+	TEST(TickTest, ClampKeepsOldTicksOld) {
+		const Tick now{ 3u << 30 };
+		Tick old{ 1 };
+		old.clamp(now);
+		EXPECT_EQ(now.get() - old.get(), Tick::MAX_CHANGE_AGE);
+		EXPECT_FALSE(old.is_newer_than(Tick{ now.get() - 10 }, now));
+
+		Tick recent{ now.get() - 5 };
+		recent.clamp(now);
+		EXPECT_EQ(recent.get(), now.get() - 5);
+	}
+
+	TEST(TickTest, WatermarkKeepsTheHighestConcurrentRaise) {
+		TickWatermark watermark;
+		utils::ThreadPool pool(3);
+		pool.parallel_for(10000, 16, [&](const size_t begin, const size_t end) {
+			for (size_t i = begin; i < end; ++i) {
+				watermark.raise(Tick{ static_cast<uint32_t>(i + 1) });
+			}
+		});
+		EXPECT_EQ(watermark.get().get(), 10000);
+
+		watermark.raise(Tick{ 5 });
+		EXPECT_EQ(watermark.get().get(), 10000);
+		watermark.clamp(Tick{ 10000 + Tick::MAX_CHANGE_AGE + 7 });
+		EXPECT_EQ(watermark.get().get(), 10007);
+	}
+
+	TEST_F(QueryTest, ChangedSkipsUntouchedColumns) {
+		for (int i = 0; i < 8; ++i) {
+			world.create_entity(QueryPosition{}, QueryVelocity{});
+			world.create_entity(QueryPosition{}, QueryTag{});
+		}
+
+		Query<const QueryPosition, Changed<QueryPosition>> changed{world};
+		changed.for_each(world, [](const QueryPosition&) {});
+
+		Query<QueryPosition, With<QueryTag>> writer{world};
+		writer.for_each(world, [](QueryPosition& position) { position.x = 1.0f; });
+
+		const auto position_id = world.component_manager().component_id<QueryPosition>();
+		size_t newer_columns = 0;
+		for (const auto table_id : changed.tables()) {
+			const auto& column = world.storage()[table_id][position_id];
+			newer_columns += column.changed_tick().is_newer_than(changed.last_run(), world.change_tick());
+		}
+		EXPECT_EQ(newer_columns, 1);
+
+		size_t count = 0;
+		changed.for_each(world, [&](const QueryPosition& position) {
+			EXPECT_FLOAT_EQ(position.x, 1.0f);
+			++count;
+		});
+		EXPECT_EQ(count, 8);
+	}
+
+	TEST_F(QueryTest, ForEachSparseJoinsSmallestSet) {
+		std::vector<Entity> burning;
+		for (int i = 0; i < 1000; ++i) {
+			const auto entity = i % 10 == 0
+				? world.create_entity(QueryPosition{}, QueryHealth{100}, QueryBurning{i})
+				: world.create_entity(QueryHealth{100});
+			if (i % 10 == 0) {
+				burning.push_back(entity);
+			}
+		}
+		world.create_entity(QueryBurning{1});
+
+		Query<QueryHealth, const QueryBurning> query{world};
+		EXPECT_TRUE((Query<QueryHealth, const QueryBurning>::IS_SPARSE_JOIN));
+		EXPECT_FALSE((Query<QueryHealth, const QueryPosition>::IS_SPARSE_JOIN));
+
+		size_t visited = 0;
+		query.for_each_sparse(world, [&](const Entity entity, QueryHealth& health, const QueryBurning& burn) {
+			EXPECT_TRUE(std::ranges::any_of(burning, [&](const Entity e) { return e.to_id() == entity.to_id(); }));
+			health.value -= burn.damage;
+			++visited;
+		});
+		EXPECT_EQ(visited, burning.size());
+
+		int joined = 0;
+		query.for_each_sparse(world, [&](const QueryHealth& health, const QueryBurning&) { joined += health.value; });
+		int iterated = 0;
+		query.for_each(world, [&](const QueryHealth& health, const QueryBurning&) { iterated += health.value; });
+		EXPECT_EQ(joined, iterated);
+
+		Query<const QueryHealth, Changed<QueryHealth>> changed{world};
+		changed.for_each(world, [](const QueryHealth&) {});
+		query.for_each_sparse(world, [](QueryHealth&, const QueryBurning&) {});
+		size_t changed_count = 0;
+		changed.for_each(world, [&](const QueryHealth&) { ++changed_count; });
+		EXPECT_EQ(changed_count, burning.size());
+	}
+}
@@ -0,0 +1,209 @@
+#include <gtest/gtest.h>
+#include <map>
+
+#include "ECS/Query/Query.h"
+#include "ECS/Snapshot/Snapshot.h"
+
+namespace glaze::ecs::tests {
+	struct Likes {
+		int amount = 0;
+	};
+
+	struct Owes {
+		static constexpr auto STORAGE_TYPE = StorageType::SparseSet;
+		int amount = 0;
+	};
+
+	struct RelationName {
+		int value = 0;
+	};
+
+	//(source, target) -> amount of every Likes pair
+	static std::map<std::pair<Entity, Entity>, int> likes(const World& world) {
+		std::map<std::pair<Entity, Entity>, int> out;
+		world.for_each_pair<Likes>([&](const Entity entity, const Entity target, const Likes& relation) {
+			out[{ entity, target }] = relation.amount;
+		});
+		return out;
+	}
+
+	TEST(RelationTest, AddsAndRemovesPairs) {
+		World world;
+		const auto a = world.create_entity(RelationName{1});
+		const auto b = world.create_entity();
+		const auto c = world.create_entity();
+
+		world.add_pair(a, b, Likes{10});
+		world.add_pair(a, c, Likes{20});
+		world.add_pair(a, b, Owes{5});
+		EXPECT_TRUE(world.has_pair<Likes>(a, b));
+		EXPECT_TRUE(world.has_pair<Likes>(a, c));
+		EXPECT_TRUE(world.has_pair<Owes>(a, b));
+		EXPECT_FALSE(world.has_pair<Owes>(a, c));
+		EXPECT_FALSE(world.has_pair<Likes>(b, a));
+
+		//pairs with different targets are different components of the relation's type
+		const auto& component_manager = world.component_manager();
+		const auto likes_b = component_manager.pair_id(component_manager.component_id<Likes>(), b);
+		ASSERT_TRUE(likes_b.valid());
+		EXPECT_NE(likes_b, component_manager.pair_id(component_manager.component_id<Likes>(), c));
+		EXPECT_TRUE(component_manager[likes_b].is_pair());
+		EXPECT_EQ(component_manager[likes_b].target(), b);
+		EXPECT_EQ(component_manager.relation_pairs(component_manager.component_id<Likes>()).size(), 2);
+		EXPECT_EQ(component_manager.target_pairs(b).size(), 2);
+
+		//replacing a pair's value keeps the entity's components
+		world.add_pair(a, b, Likes{11});
+		EXPECT_EQ(likes(world), (std::map<std::pair<Entity, Entity>, int>{ { { a, b }, 11 }, { { a, c }, 20 } }));
+
+		EXPECT_TRUE(world.remove_pair<Likes>(a, b));
+		EXPECT_FALSE(world.remove_pair<Likes>(a, b));
+		EXPECT_FALSE(world.remove_pair<Owes>(b, a));
+		EXPECT_FALSE(world.has_pair<Likes>(a, b));
+		EXPECT_TRUE(world.has_pair<Owes>(a, b));
+
+		size_t named = 0;
+		Query<const RelationName>{world}.for_each(world, [&](const RelationName& name) {
+			EXPECT_EQ(name.value, 1);
+			++named;
+		});
+		EXPECT_EQ(named, 1);
+	}
+
+	TEST(RelationTest, FindsPairsByRelationAndByTarget) {
+		World world;
+		std::vector<Entity> targets;
+		for (int i = 0; i < 4; ++i) {
+			targets.push_back(world.create_entity());
+		}
+
+		std::map<std::pair<Entity, Entity>, int> expected;
+		std::vector<Entity> sources;
+		for (int i = 0; i < 50; ++i) {
+			const auto source = world.create_entity(RelationName{i});
+			sources.push_back(source);
+			for (int t = 0; t < 4; ++t) {
+				if ((i + t) % 3 == 0) {
+					world.add_pair(source, targets[t], Likes{i * 10 + t});
+					expected[{ source, targets[t] }] = i * 10 + t;
+				}
+			}
+			if (i % 5 == 0) {
+				world.add_pair(source, targets[0], Owes{i});
+			}
+		}
+		EXPECT_EQ(likes(world), expected);
+
+		std::map<Entity, std::vector<ComponentId>> targeting;
+		world.for_each_targeting(targets[0], [&](const Entity entity, const ComponentId relation) {
+			targeting[entity].push_back(relation);
+		});
+		const auto likes_id = world.component_manager().component_id<Likes>();
+		const auto owes_id = world.component_manager().component_id<Owes>();
+		for (int i = 0; i < 50; ++i) {
+			auto relations = targeting[sources[i]];
+			std::ranges::sort(relations);
+			std::vector<ComponentId> expected_relations;
+			if (i % 3 == 0) {
+				expected_relations.push_back(likes_id);
+			}
+			if (i % 5 == 0) {
+				expected_relations.push_back(owes_id);
+			}
+			std::ranges::sort(expected_relations);
+			EXPECT_EQ(relations, expected_relations);
+		}
+	}
+
+	TEST(RelationTest, DestroyingATargetRemovesItsPairs) {
+		World world;
+		const auto target = world.create_entity();
+		const auto other = world.create_entity();
+		std::vector<Entity> sources;
+		for (int i = 0; i < 10; ++i) {
+			const auto source = world.create_entity(RelationName{i});
+			world.add_pair(source, target, Likes{i});
+			world.add_pair(source, other, Likes{-i});
+			if (i % 2 == 0) {
+				world.add_pair(source, target, Owes{i});
+			}
+			sources.push_back(source);
+		}
+
+		world.destroy_entity(target);
+		for (const auto source : sources) {
+			EXPECT_FALSE(world.has_pair<Likes>(source, target));
+			EXPECT_FALSE(world.has_pair<Owes>(source, target));
+			EXPECT_TRUE(world.has_pair<Likes>(source, other));
+		}
+
+		size_t targeting = 0;
+		world.for_each_targeting(target, [&](Entity, ComponentId) { ++targeting; });
+		EXPECT_EQ(targeting, 0);
+		EXPECT_EQ(likes(world).size(), sources.size());
+
+		//a source destroyed together with its target
+		const std::vector destroyed{ other, sources[3] };
+		EXPECT_EQ(world.destroy_entities(destroyed), 2);
+		EXPECT_TRUE(likes(world).empty());
+		size_t named = 0;
+		Query<const RelationName>{world}.for_each(world, [&](const RelationName&) { ++named; });
+		EXPECT_EQ(named, sources.size() - 1);
+	}
+
+	TEST(RelationTest, ReusesIdsOfReleasedPairs) {
+		World world;
+		const auto source = world.create_entity(RelationName{1});
+		size_t component_count = 0;
+		for (int i = 0; i < 100; ++i) {
+			const auto target = world.create_entity();
+			world.add_pair(source, target, Likes{i});
+			world.add_pair(source, target, Owes{i});
+			world.destroy_entity(target);
+			if (i == 0) {
+				component_count = world.component_manager().size();
+			}
+		}
+		EXPECT_EQ(world.component_manager().size(), component_count);
+		EXPECT_TRUE(likes(world).empty());
+		EXPECT_FALSE(world.component_manager().has_pairs());
+
+		const auto target = world.create_entity();
+		world.add_pair(source, target, Likes{7});
+		EXPECT_EQ(world.component_manager().size(), component_count);
+		EXPECT_EQ(likes(world), (std::map<std::pair<Entity, Entity>, int>{ { { source, target }, 7 } }));
+
+		//a clone follows the reused ids
+		World copy;
+		world.clone_into(copy);
+		world.destroy_entity(target);
+		const auto next = world.create_entity();
+		world.add_pair(source, next, Likes{8});
+		world.clone_into(copy);
+		EXPECT_EQ(likes(copy), (std::map<std::pair<Entity, Entity>, int>{ { { source, next }, 8 } }));
+		EXPECT_FALSE(copy.has_pair<Likes>(source, target));
+		EXPECT_EQ(copy.component_manager().size(), component_count);
+	}
+
+	TEST(RelationTest, PairsSurviveClonesAndSnapshots) {
+		World world;
+		const auto a = world.create_entity();
+		const auto b = world.create_entity();
+		const auto c = world.create_entity(RelationName{3});
+		world.add_pair(c, a, Likes{1});
+		world.add_pair(c, b, Likes{2});
+		world.add_pair(a, b, Likes{3});
+
+		World copy;
+		world.clone_into(copy);
+		EXPECT_EQ(likes(copy), likes(world));
+		EXPECT_TRUE(copy.has_pair<Likes>(c, b));
+
+		World restored;
+		restored.register_components<RelationName, Likes>();
+		ASSERT_TRUE(read_snapshot(restored, write_snapshot(world)));
+		EXPECT_EQ(likes(restored), likes(world));
+		EXPECT_TRUE(restored.has_pair<Likes>(a, b));
+		EXPECT_FALSE(restored.has_pair<Likes>(b, a));
+	}
+}
@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+#include <string>
+
+#include "ECS/World.h"
+#include "SharedResource.h"
+#include "Tracked.h"
+
+namespace glaze::ecs::tests {
+	struct ResourceTime {
+		double delta = 0.0;
+		uint64_t frame = 0;
+	};
+
+	struct ResourceConfig {
+		std::string name;
+		int quality = 1;
+	};
+
+	struct ResourceHit {
+		uint32_t target = 0;
+	};
+
+	TEST(ResourcesTest, InsertsReadsAndRemovesSingletons) {
+		World world;
+		EXPECT_EQ(world.get_resource<ResourceTime>(), nullptr);
+		EXPECT_FALSE(world.has_resource<ResourceTime>());
+
+		world.insert_resource<ResourceTime>(0.016, uint64_t{1});
+		world.insert_resource<ResourceConfig>("high", 3);
+		EXPECT_EQ(world.resource<ResourceTime>().frame, 1);
+		EXPECT_EQ(world.resource<ResourceConfig>().name, "high");
+
+		++world.resource<ResourceTime>().frame;
+		const auto& const_world = world;
+		EXPECT_EQ(const_world.resource<ResourceTime>().frame, 2);
+		EXPECT_EQ(const_world.get_resource<ResourceTime>(), world.get_resource<ResourceTime>());
+
+		//init keeps the existing resource, insert replaces it
+		EXPECT_EQ(world.init_resource<ResourceConfig>("low", 0).quality, 3);
+		EXPECT_EQ(world.insert_resource<ResourceConfig>("low", 0).quality, 0);
+		EXPECT_EQ(world.resources().size(), 2);
+
+		EXPECT_TRUE(world.remove_resource<ResourceTime>());
+		EXPECT_FALSE(world.remove_resource<ResourceTime>());
+		EXPECT_FALSE(world.has_resource<ResourceTime>());
+		EXPECT_TRUE(world.has_resource<ResourceConfig>());
+		EXPECT_EQ(world.resources().size(), 1);
+	}
+
+	TEST(ResourcesTest, DestroysResources) {
+		Tracked::alive = 0;
+		{
+			World world;
+			world.insert_resource<Tracked>();
+			world.insert_resource<Tracked>();
+			EXPECT_EQ(Tracked::alive, 1);
+			world.remove_resource<Tracked>();
+			EXPECT_EQ(Tracked::alive, 0);
+			world.insert_resource<Tracked>();
+		}
+		EXPECT_EQ(Tracked::alive, 0);
+	}
+
+	TEST(ResourcesTest, UpdatesEventResources) {
+		World world;
+		auto& hits = world.add_events<ResourceHit>();
+		EXPECT_EQ(&world.add_events<ResourceHit>(), &hits);
+		EXPECT_EQ(&world.resource<Events<ResourceHit>>(), &hits);
+
+		EventCursor reader;
+		hits.send(ResourceHit{ 1 });
+		world.update_events();
+		hits.send(ResourceHit{ 2 });
+		EXPECT_EQ(hits.read(reader).size(), 2);
+
+		//the first event is dropped after its second update
+		world.update_events();
+		EXPECT_EQ(hits.size(), 1);
+		world.update_events();
+		EXPECT_TRUE(hits.empty());
+	}
+
+	TEST(ResourcesTest, FindsResourcesOfOtherTranslationUnits) {
+		ASSERT_NE(shared_resource_index(), utils::TypeIndex<SharedResource>::value);
+
+		World world;
+		world.insert_resource<ResourceTime>();
+		insert_shared_resource(world, 1);
+		ASSERT_TRUE(world.has_resource<SharedResource>());
+		EXPECT_EQ(world.resource<SharedResource>().value, 1);
+
+		//replaced, not inserted twice
+		world.insert_resource<SharedResource>(2);
+		EXPECT_EQ(world.resources().size(), 2);
+		EXPECT_EQ(get_shared_resource(world), world.get_resource<SharedResource>());
+		EXPECT_EQ(get_shared_resource(world)->value, 2);
+
+		EXPECT_TRUE(world.remove_resource<SharedResource>());
+		EXPECT_EQ(get_shared_resource(world), nullptr);
+		world.insert_resource<SharedResource>(3);
+		EXPECT_EQ(get_shared_resource(world)->value, 3);
+		EXPECT_EQ(world.resources().size(), 2);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,25 @@
+#include <utility>
+
+#include "SharedResource.h"
+
+namespace glaze::ecs::tests {
+	template<size_t N>
+	struct UnitPadding {};
+
+	//takes the first indices of this translation unit, so SharedResource gets another one than in test_Resources.cpp
+	[[maybe_unused]] static constexpr uint64_t PADDING = []<size_t ... Is>(std::index_sequence<Is...>) {
+		return (utils::TypeIndex<UnitPadding<Is>>::value + ...);
+	}(std::make_index_sequence<32>{});
+
+	SharedResource& insert_shared_resource(World& world, const int value) {
+		return world.insert_resource<SharedResource>(value);
+	}
+
+	SharedResource* get_shared_resource(World& world) {
+		return world.get_resource<SharedResource>();
+	}
+
+	uint64_t shared_resource_index() {
+		return utils::TypeIndex<SharedResource>::value;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+
+#include "ECS/Command/Commands.h"
+#include "ECS/Schedule/Schedule.h"
+
+namespace glaze::ecs::tests {
+	struct SchedulePosition {
+		float x = 0.0f;
+	};
+
+	struct ScheduleVelocity {
+		float x = 0.0f;
+	};
+
+	struct ScheduleHealth {
+		static constexpr auto STORAGE_TYPE = StorageType::SparseSet;
+		int value = 0;
+	};
+
+	struct ScheduleTest : testing::Test {
+	protected:
+		World world;
+	};
+
+	TEST_F(ScheduleTest, DerivesAccessFromQueryTerms) {
+		const Query<SchedulePosition, const ScheduleVelocity, With<ScheduleHealth>, Changed<ScheduleHealth>> query{world};
+		const auto access = query.access();
+
+		const auto position = world.register_component<SchedulePosition>();
+		const auto velocity = world.register_component<ScheduleVelocity>();
+		const auto health = world.register_component<ScheduleHealth>();
+
+		EXPECT_TRUE(std::ranges::equal(access.writes(), std::array{position}));
+		EXPECT_TRUE(std::ranges::contains(access.reads(), velocity));
+		EXPECT_TRUE(std::ranges::contains(access.reads(), health));
+		EXPECT_FALSE(access.is_exclusive());
+	}
+
+	TEST_F(ScheduleTest, OrdersOnlyConflictingSystems) {
+		Schedule schedule;
+		const auto integrate = schedule.add_system<Query<SchedulePosition, const ScheduleVelocity>>(world, [](World&, auto&) {});
+		const auto heal = schedule.add_system<Query<ScheduleHealth>>(world, [](World&, auto&) {});
+		const auto read_position = schedule.add_system<Query<const SchedulePosition>>(world, [](World&, auto&) {});
+		const auto read_both = schedule.add_system<Query<const SchedulePosition>, Query<const ScheduleHealth>>(world, [](World&, auto&, auto&) {});
+		const auto accelerate = schedule.add_system<Query<ScheduleVelocity>>(world, [](World&, auto&) {});
+		const auto apply = schedule.add_exclusive_system([](World&) {});
+
+		EXPECT_TRUE(schedule.dependencies(integrate).empty());
+		EXPECT_TRUE(schedule.dependencies(heal).empty());
+		EXPECT_EQ(schedule.dependencies(read_position), std::vector{integrate});
+		EXPECT_EQ(schedule.dependencies(read_both), (std::vector{integrate, heal}));
+		EXPECT_EQ(schedule.dependencies(accelerate), std::vector{integrate});
+		EXPECT_EQ(schedule.dependencies(apply), (std::vector{integrate, heal, read_position, read_both, accelerate}));
+	}
+
+	TEST_F(ScheduleTest, ParallelRunMatchesSequentialOrder) {
+		static constexpr int COUNT = 10000;
+		for (int i = 0; i < COUNT; ++i) {
+			world.create_entity(SchedulePosition{}, ScheduleVelocity{1.0f});
+			world.create_entity(ScheduleHealth{0});
+		}
+
+		Commands commands;
+		Schedule schedule;
+		schedule.add_system<Query<ScheduleVelocity>>(world, [](World& w, auto& query) {
+			query.for_each(w, [](ScheduleVelocity& velocity) { velocity.x *= 2.0f; });
+		});
+		schedule.add_system<Query<ScheduleHealth>>(world, [](World& w, auto& query) {
+			query.for_each(w, [](ScheduleHealth& health) { ++health.value; });
+		});
+		schedule.add_system<Query<SchedulePosition, const ScheduleVelocity>>(world, [](World& w, auto& query) {
+			query.for_each(w, [](SchedulePosition& position, const ScheduleVelocity& velocity) { position.x += velocity.x; });
+		});
+		schedule.add_system<Query<const ScheduleHealth>>(world, [&](World& w, auto& query) {
+			query.for_each(w, [&](const Entity entity, const ScheduleHealth& health) {
+				if (health.value == 2) {
+					commands.despawn(entity);
+				}
+			});
+		});
+		schedule.add_exclusive_system([&](World& w) { commands.apply(w); });
+
+		utils::ThreadPool pool{3};
+		schedule.run(world, pool);
+		schedule.run(world, pool);
+
+		float position = 0.0f;
+		Query<const SchedulePosition>{world}.for_each(world, [&](const SchedulePosition& p) { position += p.x; });
+		//velocity doubles before every integration
+		EXPECT_FLOAT_EQ(position, COUNT * (2.0f + 4.0f));
+
+		size_t health = 0;
+		Query<const ScheduleHealth>{world}.for_each(world, [&](const ScheduleHealth&) { ++health; });
+		EXPECT_EQ(health, 0);
+		EXPECT_EQ(world.entity_manager().size(), COUNT);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,246 @@
+#include <gtest/gtest.h>
+#include <array>
+#include <cstring>
+#include <map>
+
+#include "ECS/Query/Query.h"
+#include "ECS/Snapshot/Delta.h"
+#include "ECS/Snapshot/Snapshot.h"
+
+namespace glaze::ecs::tests {
+	struct SnapshotPosition {
+		float x = 0.0f;
+		float y = 0.0f;
+	};
+
+	struct SnapshotVelocity {
+		double x = 0.0;
+	};
+
+	struct SnapshotHealth {
+		static constexpr auto STORAGE_TYPE = StorageType::SparseSet;
+		int value = 0;
+	};
+
+	struct SnapshotTag {};
+
+	struct SnapshotLikes {
+		int weight = 0;
+	};
+
+	struct SnapshotTest : testing::Test {
+	protected:
+		void fill() {
+			for (int i = 0; i < 100; ++i) {
+				const auto f = static_cast<float>(i);
+				if (i % 3 == 0) {
+					entities.push_back(world.create_entity(SnapshotPosition{f, -f}, SnapshotVelocity{f * 2.0}));
+				} else if (i % 3 == 1) {
+					entities.push_back(world.create_entity(SnapshotPosition{f, -f}, SnapshotHealth{i}, SnapshotTag{}));
+				} else {
+					entities.push_back(world.create_entity());
+				}
+			}
+
+			std::vector<Entity> destroyed;
+			for (size_t i = 0; i < entities.size(); i += 7) {
+				destroyed.push_back(entities[i]);
+			}
+			world.destroy_entities(destroyed);
+			std::erase_if(entities, [&](const Entity entity) { return std::ranges::contains(destroyed, entity); });
+		}
+
+		//components of every entity, keyed by entity
+		static std::map<Entity, std::tuple<float, double, int>> contents(World& w) {
+			std::map<Entity, std::tuple<float, double, int>> out;
+			Query<const SnapshotPosition>{w}.for_each(w, [&](const Entity entity, const SnapshotPosition& position) {
+				std::get<0>(out[entity]) = position.x;
+			});
+			Query<const SnapshotVelocity>{w}.for_each(w, [&](const Entity entity, const SnapshotVelocity& velocity) {
+				std::get<1>(out[entity]) = velocity.x;
+			});
+			Query<const SnapshotHealth, With<SnapshotTag>>{w}.for_each(w, [&](const Entity entity, const SnapshotHealth& health) {
+				std::get<2>(out[entity]) = health.value;
+			});
+			return out;
+		}
+
+		World world;
+		std::vector<Entity> entities;
+	};
+
+	TEST_F(SnapshotTest, RestoresEntitiesAndComponents) {
+		fill();
+		const auto bytes = write_snapshot(world);
+
+		//ids of the loading world differ from the writer's
+		World restored;
+		restored.register_components<SnapshotTag, SnapshotHealth, SnapshotVelocity, SnapshotPosition>();
+		ASSERT_TRUE(read_snapshot(restored, bytes));
+
+		EXPECT_EQ(restored.entity_manager().size(), world.entity_manager().size());
+		EXPECT_EQ(restored.entity_manager().max_size(), world.entity_manager().max_size());
+		for (const auto entity : entities) {
+			EXPECT_TRUE(restored.entity_manager().is_valid(entity));
+		}
+		EXPECT_EQ(contents(restored), contents(world));
+
+		//destroyed slots are reused in the same order
+		EXPECT_EQ(restored.create_entity(), world.create_entity());
+	}
+
+	TEST_F(SnapshotTest, LoadsChunkedTablesFromFile) {
+		world.storage().table_manager.set_chunk_bytes(256);
+		fill();
+
+		const auto path = std::filesystem::temp_directory_path() / "glaze_snapshot_test.bin";
+		ASSERT_TRUE(save_snapshot(world, path));
+
+		World restored;
+		restored.storage().table_manager.set_chunk_bytes(512);
+		restored.register_components<SnapshotPosition, SnapshotVelocity, SnapshotHealth, SnapshotTag>();
+		ASSERT_TRUE(load_snapshot(restored, path));
+		std::filesystem::remove(path);
+
+		EXPECT_EQ(contents(restored), contents(world));
+	}
+
+	TEST_F(SnapshotTest, RejectsMalformedSnapshots) {
+		fill();
+		auto bytes = write_snapshot(world);
+
+		World truncated;
+		truncated.register_components<SnapshotPosition, SnapshotVelocity, SnapshotHealth, SnapshotTag>();
+		EXPECT_FALSE(read_snapshot(truncated, std::span(bytes).first(bytes.size() / 2)));
+
+		//the last copy of an entity is its archetype entry, the table row after it points past the table
+		auto out_of_range = bytes;
+		const auto entity = std::as_bytes(std::span(&entities.back(), 1));
+		const auto entry = std::ranges::find_end(out_of_range, entity);
+		ASSERT_FALSE(entry.empty());
+		const auto row = TableRow::from_index(1000);
+		std::memcpy(std::to_address(entry.end()), &row, sizeof(row));
+		World bad_row;
+		bad_row.register_components<SnapshotPosition, SnapshotVelocity, SnapshotHealth, SnapshotTag>();
+		EXPECT_FALSE(read_snapshot(bad_row, out_of_range));
+
+		bytes[0] = std::byte{'X'};
+		World corrupted;
+		EXPECT_FALSE(read_snapshot(corrupted, bytes));
+	}
+
+	TEST_F(SnapshotTest, RejectsBadSparseSetEntities) {
+		world.create_entity(SnapshotHealth{1});
+		world.create_entity(SnapshotHealth{2});
+		world.destroy_entity(world.create_entity());
+		const auto bytes = write_snapshot(world);
+
+		//the entity count of the only sparse set, followed by its dense entity indices
+		const std::array<uint32_t, 4> dense{ 2, 0, 0, 1 };
+		const auto entry = std::ranges::find_end(bytes, std::as_bytes(std::span(dense)));
+		ASSERT_FALSE(entry.empty());
+		const auto with_second = [&](const uint32_t index) {
+			auto patched = bytes;
+			std::memcpy(patched.data() + (entry.end() - bytes.begin()) - sizeof(index), &index, sizeof(index));
+			World restored;
+			restored.register_components<SnapshotHealth>();
+			return read_snapshot(restored, patched);
+		};
+
+		EXPECT_TRUE(with_second(1));
+		//stored twice
+		EXPECT_FALSE(with_second(0));
+		//the destroyed entity
+		EXPECT_FALSE(with_second(2));
+	}
+
+	TEST_F(SnapshotTest, DeltaCarriesChangesSinceTheBaseline) {
+		fill();
+		const auto snapshot = write_snapshot(world);
+		DeltaRecorder recorder{world};
+
+		World restored;
+		restored.register_components<SnapshotTag, SnapshotHealth, SnapshotVelocity, SnapshotPosition>();
+		ASSERT_TRUE(read_snapshot(restored, snapshot));
+
+		//spawned, despawned, moved and changed entities
+		std::vector<Entity> destroyed{ entities[0], entities[5], entities[6] };
+		world.destroy_entities(destroyed);
+		entities.push_back(world.create_entity(SnapshotPosition{500.0f, 0.0f}, SnapshotHealth{500}, SnapshotTag{}));
+		entities.push_back(world.create_entity(SnapshotVelocity{600.0}));
+		world.add_components(entities[10], SnapshotVelocity{700.0});
+		Query<SnapshotVelocity> writer{world};
+		writer.for_each(world, [](SnapshotVelocity& velocity) { velocity.x += 1.0; });
+
+		const auto delta = recorder.write(world);
+		ASSERT_TRUE(apply_delta(restored, delta));
+		EXPECT_EQ(restored.entity_manager().size(), world.entity_manager().size());
+		EXPECT_EQ(contents(restored), contents(world));
+		for (const auto entity : destroyed) {
+			EXPECT_FALSE(restored.entity_manager().is_valid(entity));
+		}
+
+		//nothing happened since the last delta
+		const auto empty = recorder.write(world);
+		EXPECT_LT(empty.size(), delta.size());
+		EXPECT_FALSE(apply_delta(restored, std::span(empty).first(empty.size() / 2)));
+		ASSERT_TRUE(apply_delta(restored, empty));
+		EXPECT_EQ(contents(restored), contents(world));
+		EXPECT_EQ(restored.create_entity(), world.create_entity());
+	}
+
+	TEST_F(SnapshotTest, DeltaKeepsChildrenOfMovedParents) {
+		const auto parent = world.create_entity(SnapshotPosition{1.0f, 0.0f});
+		const auto first = world.create_entity(SnapshotPosition{2.0f, 0.0f});
+		const auto second = world.create_entity(SnapshotPosition{3.0f, 0.0f});
+		world.set_parent(first, parent);
+		world.set_parent(second, parent);
+		const auto doomed = world.create_entity();
+		const auto orphan = world.create_entity();
+		world.set_parent(orphan, doomed);
+
+		const auto snapshot = write_snapshot(world);
+		DeltaRecorder recorder{world};
+		World restored;
+		restored.register_components<ChildOf, SnapshotTag, SnapshotHealth, SnapshotVelocity, SnapshotPosition>();
+		ASSERT_TRUE(read_snapshot(restored, snapshot));
+
+		//the parent only changes its archetype, the destroyed one leaves a root behind
+		world.add_components(parent, SnapshotVelocity{1.0});
+		world.destroy_entity(doomed);
+		ASSERT_TRUE(apply_delta(restored, recorder.write(world)));
+
+		EXPECT_EQ(restored.hierarchy().parent(first), parent);
+		EXPECT_EQ(restored.hierarchy().parent(second), parent);
+		EXPECT_FALSE(restored.hierarchy().parent(orphan).has_value());
+		EXPECT_FALSE(restored.entity_manager().is_valid(doomed));
+		EXPECT_EQ(contents(restored), contents(world));
+	}
+
+	TEST_F(SnapshotTest, DeltaKeepsPairsOfMovedTargets) {
+		const auto a = world.create_entity(SnapshotPosition{1.0f, 0.0f});
+		const auto b = world.create_entity(SnapshotPosition{2.0f, 0.0f});
+		const auto c = world.create_entity(SnapshotPosition{3.0f, 0.0f});
+		world.add_pair(a, b, SnapshotLikes{1});
+		world.add_pair(a, c, SnapshotLikes{2});
+		world.add_pair(c, b, SnapshotLikes{3});
+
+		const auto snapshot = write_snapshot(world);
+		DeltaRecorder recorder{world};
+		World restored;
+		restored.register_components<SnapshotLikes, SnapshotTag, SnapshotHealth, SnapshotVelocity, SnapshotPosition>();
+		ASSERT_TRUE(read_snapshot(restored, snapshot));
+
+		//the target b only changes its archetype, pairs targeting the destroyed c are removed on both sides
+		world.add_components(b, SnapshotVelocity{1.0});
+		world.destroy_entity(c);
+		ASSERT_TRUE(apply_delta(restored, recorder.write(world)));
+
+		std::vector<std::tuple<Entity, Entity, int>> pairs;
+		restored.for_each_pair<SnapshotLikes>([&](const Entity entity, const Entity target, const SnapshotLikes& likes) {
+			pairs.emplace_back(entity, target, likes.weight);
+		});
+		EXPECT_EQ(pairs, (std::vector<std::tuple<Entity, Entity, int>>{ { a, b, 1 } }));
+		EXPECT_EQ(contents(restored), contents(world));
+	}
+}
\ No newline at end of file
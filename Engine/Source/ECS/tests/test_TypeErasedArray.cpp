@@ -31,6 +31,19 @@ namespace glaze::ecs::tests {
 
 	struct TagComponent {};
 
+	//owns nothing address dependent, so its bytes can be moved even though it isn't trivially copyable
+	struct RelocatableComponent {
+		static constexpr bool TRIVIALLY_RELOCATABLE = true;
+		static inline int destroyed = 0;
+
+		RelocatableComponent(int x = 0) noexcept : x(x) {}
+		RelocatableComponent(RelocatableComponent&& other) noexcept : x(other.x) {}
+		RelocatableComponent& operator=(RelocatableComponent&& other) noexcept = default;
+		~RelocatableComponent() { ++destroyed; }
+
+		int x = 0;
+	};
+
 	TEST(TypeErasedArray, Empty) {
 		TypeErasedArray array;
 
@@ -167,4 +180,77 @@ namespace glaze::ecs::tests {
 		ASSERT_NE(data_2, nullptr);
 		ASSERT_NE(data_3, nullptr);
 	}
-}
\ No newline at end of file
+
+	TEST(TypeErasedArray, TypeOpsRelocatability) {
+		EXPECT_TRUE(utils::TypeOps::of<int>().trivially_relocatable);
+		EXPECT_TRUE(utils::TypeOps::of<int>().trivially_destructible);
+		EXPECT_TRUE(utils::TypeOps::of<RelocatableComponent>().trivially_relocatable);
+		EXPECT_FALSE(utils::TypeOps::of<RelocatableComponent>().trivially_destructible);
+		EXPECT_FALSE(utils::TypeOps::of<TestComponent>().trivially_relocatable);
+	}
+
+	TEST(TypeErasedArray, SwapRemove) {
+		TypeErasedArray array(utils::Layout::of<TestComponent>(), utils::TypeOps::of<TestComponent>());
+		for (int i = 0; i < 4; ++i) {
+			array.emplace_back<TestComponent>(i);
+		}
+
+		array.swap_remove(1);
+		array.swap_remove(2);
+
+		ASSERT_EQ(array.size(), 2);
+		EXPECT_EQ(array.get<TestComponent>(0)->x, 0);
+		EXPECT_EQ(array.get<TestComponent>(1)->x, 3);
+	}
+
+	TEST(TypeErasedArray, RelocatableSkipsMovesAndDestructors) {
+		RelocatableComponent::destroyed = 0;
+		{
+			TypeErasedArray array(utils::Layout::of<RelocatableComponent>(), utils::TypeOps::of<RelocatableComponent>());
+			for (int i = 0; i < 100; ++i) {
+				array.emplace_back<RelocatableComponent>(i);
+			}
+			//growing the array copies bytes, nothing gets destroyed
+			EXPECT_EQ(RelocatableComponent::destroyed, 0);
+
+			array.swap_remove(10);
+			EXPECT_EQ(RelocatableComponent::destroyed, 1);
+			EXPECT_EQ(array.get<RelocatableComponent>(10)->x, 99);
+
+			TypeErasedArray other(utils::Layout::of<RelocatableComponent>(), utils::TypeOps::of<RelocatableComponent>());
+			other.relocate_emplace_back(array.get(20));
+			array.swap_remove_relocated(20);
+			EXPECT_EQ(RelocatableComponent::destroyed, 1);
+			EXPECT_EQ(other.get<RelocatableComponent>(0)->x, 20);
+			EXPECT_EQ(array.get<RelocatableComponent>(20)->x, 98);
+			EXPECT_EQ(array.size(), 98);
+		}
+		EXPECT_EQ(RelocatableComponent::destroyed, 100);
+	}
+
+	TEST(TypeErasedArray, ChunkedGrowthNeverMovesElements) {
+		static constexpr size_t CHUNK_ROWS = 16;
+		TypeErasedArray array(utils::Layout::of<TestComponent>(), utils::TypeOps::of<TestComponent>(), 0, CHUNK_ROWS);
+		EXPECT_TRUE(array.chunked());
+
+		array.emplace_back<TestComponent>(0);
+		const TestComponent* const first = array.get<TestComponent>(0);
+		EXPECT_EQ(array.capacity(), CHUNK_ROWS);
+
+		for (int i = 1; i < 100; ++i) {
+			array.emplace_back<TestComponent>(i);
+		}
+		EXPECT_EQ(array.get<TestComponent>(0), first);
+		EXPECT_EQ(array.capacity(), 7 * CHUNK_ROWS);
+		EXPECT_EQ(array.data(), nullptr);
+
+		const auto slice = array.get_slice<TestComponent>(CHUNK_ROWS, CHUNK_ROWS);
+		for (size_t i = 0; i < slice.size(); ++i) {
+			EXPECT_EQ(slice[i].x, static_cast<int>(CHUNK_ROWS + i));
+		}
+
+		array.swap_remove(3);
+		EXPECT_EQ(array.get<TestComponent>(3)->x, 99);
+		EXPECT_EQ(array.size(), 99);
+	}
+}
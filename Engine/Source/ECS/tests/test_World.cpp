@@ -0,0 +1,371 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <utility>
+
+#include "ECS/World.h"
+#include "Utils/MemoryArena.h"
+#include "Tracked.h"
+
+namespace glaze::ecs::tests {
+	struct WorldPosition {
+		float x = 0.0f;
+		float y = 0.0f;
+	};
+
+	struct WorldVelocity {
+		float x = 0.0f;
+		float y = 0.0f;
+	};
+
+	struct WorldHealth {
+		static constexpr auto STORAGE_TYPE = StorageType::SparseSet;
+		int value = 0;
+	};
+
+	//enough of them to get ids past ComponentMask::CAPACITY
+	template<size_t N>
+	struct WorldWide {
+		static constexpr auto STORAGE_TYPE = StorageType::SparseSet;
+		int value = 0;
+	};
+
+	struct WorldSpawnBundle {
+		WorldPosition position;
+		WorldHealth health;
+
+		auto components() && { return std::forward_as_tuple(std::move(position), std::move(health)); }
+	};
+
+	struct WorldTest : testing::Test {
+	protected:
+		void SetUp() override { Tracked::alive = 0; }
+
+		template<Component T>
+		T* get(const Entity entity) {
+			const auto location = world.entity_manager().get_location(entity);
+			if (!location) {
+				return nullptr;
+			}
+
+			const auto component_id = world.component_manager().component_id<T>();
+			if constexpr (get_storage_type<T>() == StorageType::Table) {
+				auto column = world.storage()[location->table_id].at(component_id);
+				return column ? column->get().data().template get<T>(location->table_row.to_index()) : nullptr;
+			} else {
+				auto sparse_set = world.storage().sparse_sets.at(component_id);
+				if (!sparse_set) {
+					return nullptr;
+				}
+				return sparse_set->get().template get<T>(entity).transform([](const auto c) { return &c.get(); }).value_or(nullptr);
+			}
+		}
+
+		ArchetypeId archetype_of(const Entity entity) const {
+			return world.entity_manager().get_location(entity).value().archetype_id;
+		}
+
+		World world;
+	};
+
+	TEST_F(WorldTest, AddComponentsMovesEntity) {
+		const auto a = world.create_entity(WorldPosition{1.0f, 2.0f});
+		const auto b = world.create_entity(WorldPosition{3.0f, 4.0f});
+
+		world.add_components(a, WorldVelocity{5.0f, 6.0f}, WorldHealth{7});
+
+		ASSERT_NE(get<WorldPosition>(a), nullptr);
+		EXPECT_FLOAT_EQ(get<WorldPosition>(a)->y, 2.0f);
+		ASSERT_NE(get<WorldVelocity>(a), nullptr);
+		EXPECT_FLOAT_EQ(get<WorldVelocity>(a)->x, 5.0f);
+		ASSERT_NE(get<WorldHealth>(a), nullptr);
+		EXPECT_EQ(get<WorldHealth>(a)->value, 7);
+
+		//b was swapped into a's old row
+		ASSERT_NE(get<WorldPosition>(b), nullptr);
+		EXPECT_FLOAT_EQ(get<WorldPosition>(b)->x, 3.0f);
+		EXPECT_EQ(get<WorldVelocity>(b), nullptr);
+	}
+
+	TEST_F(WorldTest, AddExistingComponentReplacesIt) {
+		const auto entity = world.create_entity(WorldPosition{1.0f, 1.0f});
+		const auto archetype_id = archetype_of(entity);
+
+		world.add_components(entity, WorldPosition{2.0f, 2.0f});
+		EXPECT_EQ(archetype_of(entity), archetype_id);
+		EXPECT_FLOAT_EQ(get<WorldPosition>(entity)->x, 2.0f);
+	}
+
+	TEST_F(WorldTest, RemoveComponentsDropsThem) {
+		const auto a = world.create_entity(WorldPosition{1.0f, 1.0f}, Tracked{1}, WorldHealth{3});
+		const auto b = world.create_entity(WorldPosition{2.0f, 2.0f}, Tracked{2}, WorldHealth{4});
+		EXPECT_EQ(Tracked::alive, 2);
+
+		EXPECT_TRUE(world.remove_components<Tracked>(a));
+		EXPECT_EQ(Tracked::alive, 1);
+		EXPECT_EQ(get<Tracked>(a), nullptr);
+		EXPECT_FLOAT_EQ(get<WorldPosition>(a)->x, 1.0f);
+		EXPECT_EQ(get<Tracked>(b)->value, 2);
+
+		EXPECT_TRUE(world.remove_components<WorldHealth>(a));
+		EXPECT_EQ(get<WorldHealth>(a), nullptr);
+		EXPECT_EQ(get<WorldHealth>(b)->value, 4);
+
+		EXPECT_FALSE(world.remove_components<WorldHealth>(a));
+		EXPECT_FALSE(world.remove_components<WorldVelocity>(a));
+
+		world.destroy_entity(b);
+		EXPECT_EQ(Tracked::alive, 0);
+		EXPECT_FALSE(world.remove_components<WorldPosition>(b));
+	}
+
+	TEST_F(WorldTest, EdgesCacheColumnMaps) {
+		const auto a = world.create_entity(WorldPosition{});
+		const auto b = world.create_entity(WorldPosition{});
+		world.add_components(a, WorldVelocity{});
+
+		const auto position_archetype = archetype_of(b);
+		const auto bundle_id = world.bundle_manager().bundle_id<ComponentBundle<WorldVelocity&&>>();
+		const auto edge = world.archetype_manager()[position_archetype].edges().at(bundle_id);
+		ASSERT_TRUE(edge.has_value());
+		EXPECT_EQ(edge->get().add, archetype_of(a));
+		ASSERT_EQ(edge->get().add_columns.size(), 1);
+		EXPECT_NE(edge->get().add_columns[0], Table::NO_COLUMN);
+
+		world.add_components(b, WorldVelocity{});
+		EXPECT_EQ(archetype_of(b), archetype_of(a));
+
+		world.remove_components<WorldPosition>(b);
+		const auto velocity_archetype = archetype_of(b);
+		EXPECT_EQ(world.archetype_manager()[velocity_archetype].component_count(), 1);
+		EXPECT_EQ(get<WorldPosition>(b), nullptr);
+		EXPECT_NE(get<WorldVelocity>(b), nullptr);
+	}
+
+	TEST_F(WorldTest, SpawnBatchWritesEveryBundle) {
+		const auto first = world.create_entity(WorldPosition{-1.0f, -1.0f}, WorldHealth{-1});
+		world.destroy_entity(world.create_entity(WorldVelocity{}));
+
+		std::vector<WorldSpawnBundle> bundles;
+		for (int i = 0; i < 100; ++i) {
+			bundles.push_back({ WorldPosition{static_cast<float>(i), 0.0f}, WorldHealth{i} });
+		}
+
+		const auto entities = world.spawn_batch(std::move(bundles));
+		ASSERT_EQ(entities.size(), 100);
+		EXPECT_EQ(world.entity_manager().size(), 101);
+		EXPECT_EQ(archetype_of(entities[0]), archetype_of(first));
+
+		for (int i = 0; i < 100; ++i) {
+			EXPECT_FLOAT_EQ(get<WorldPosition>(entities[i])->x, static_cast<float>(i));
+			EXPECT_EQ(get<WorldHealth>(entities[i])->value, i);
+		}
+		EXPECT_EQ(get<WorldHealth>(first)->value, -1);
+	}
+
+	TEST_F(WorldTest, SpawnNUsesGenerator) {
+		const auto entities = world.spawn_n<WorldSpawnBundle>(64, [](const size_t i) {
+			return WorldSpawnBundle{ WorldPosition{0.0f, static_cast<float>(i)}, WorldHealth{static_cast<int>(i) * 2} };
+		});
+
+		ASSERT_EQ(entities.size(), 64);
+		const auto& table = world.storage()[world.entity_manager().get_location(entities[0])->table_id];
+		EXPECT_EQ(table.entity_count(), 64);
+		for (size_t i = 0; i < entities.size(); ++i) {
+			EXPECT_EQ(table.entities()[i].to_id(), entities[i].to_id());
+			EXPECT_FLOAT_EQ(get<WorldPosition>(entities[i])->y, static_cast<float>(i));
+			EXPECT_EQ(get<WorldHealth>(entities[i])->value, static_cast<int>(i) * 2);
+		}
+
+		EXPECT_TRUE(world.spawn_n<WorldSpawnBundle>(0, [](size_t) { return WorldSpawnBundle{}; }).empty());
+	}
+
+	TEST_F(WorldTest, DestroyEntitiesCompactsTables) {
+		std::vector<Entity> entities;
+		for (int i = 0; i < 50; ++i) {
+			//two archetypes sharing one table and one with its own
+			if (i % 3 == 0) {
+				entities.push_back(world.create_entity(Tracked{i}, WorldHealth{i}));
+			} else if (i % 3 == 1) {
+				entities.push_back(world.create_entity(Tracked{i}));
+			} else {
+				entities.push_back(world.create_entity(Tracked{i}, WorldPosition{}));
+			}
+		}
+
+		std::vector<Entity> to_destroy;
+		for (int i = 0; i < 50; ++i) {
+			if (i % 4 == 0 || i > 45) {
+				to_destroy.push_back(entities[i]);
+			}
+		}
+		to_destroy.push_back(entities[0]);
+		const auto destroyed_count = to_destroy.size() - 1;
+
+		EXPECT_EQ(world.destroy_entities(to_destroy), destroyed_count);
+		EXPECT_EQ(world.entity_manager().size(), 50 - destroyed_count);
+		EXPECT_EQ(Tracked::alive, static_cast<int>(50 - destroyed_count));
+		EXPECT_EQ(world.storage().sparse_sets[world.component_manager().component_id<WorldHealth>()].size(), 12);
+
+		for (int i = 0; i < 50; ++i) {
+			const bool destroyed = i % 4 == 0 || i > 45;
+			EXPECT_EQ(world.entity_manager().is_valid(entities[i]), !destroyed);
+			if (destroyed) {
+				continue;
+			}
+
+			ASSERT_NE(get<Tracked>(entities[i]), nullptr);
+			EXPECT_EQ(get<Tracked>(entities[i])->value, i);
+			if (i % 3 == 0) {
+				EXPECT_EQ(get<WorldHealth>(entities[i])->value, i);
+			}
+
+			const auto location = *world.entity_manager().get_location(entities[i]);
+			const auto& archetype = world.archetype_manager()[location.archetype_id];
+			EXPECT_EQ(archetype.entities()[location.archetype_row.to_index()].entity.to_id(), entities[i].to_id());
+			EXPECT_EQ(archetype.entity_table_row(location.archetype_row), location.table_row);
+		}
+
+		EXPECT_EQ(world.destroy_entities(to_destroy), 0);
+	}
+
+	TEST_F(WorldTest, ReservesEntitiesFromSeveralThreads) {
+		std::vector<Entity> destroyed;
+		for (int i = 0; i < 100; ++i) {
+			const auto entity = world.create_entity(WorldPosition{});
+			if (i % 2 == 0) {
+				destroyed.push_back(entity);
+			}
+		}
+		world.destroy_entities(destroyed);
+
+		static constexpr size_t THREADS = 4;
+		static constexpr size_t PER_THREAD = 64;
+		std::vector<Entity> reserved(THREADS * PER_THREAD);
+		{
+			std::vector<std::jthread> threads;
+			for (size_t t = 0; t < THREADS; ++t) {
+				threads.emplace_back([&, t] {
+					const auto first = t * PER_THREAD;
+					for (size_t i = 0; i < PER_THREAD / 2; ++i) {
+						reserved[first + i] = world.reserve_entity();
+					}
+					world.reserve_entities(std::span(reserved).subspan(first + PER_THREAD / 2, PER_THREAD / 2));
+				});
+			}
+		}
+
+		//reserved ids are unique, reuse the destroyed slots first and don't exist before the flush
+		auto sorted = reserved;
+		std::ranges::sort(sorted);
+		EXPECT_EQ(std::ranges::adjacent_find(sorted), sorted.end());
+		EXPECT_EQ(world.entity_manager().max_size(), 100);
+		for (const auto entity : reserved) {
+			EXPECT_FALSE(world.entity_manager().get_location(entity).has_value());
+		}
+
+		world.flush_entities();
+		EXPECT_EQ(world.entity_manager().size(), 50 + reserved.size());
+		EXPECT_EQ(world.entity_manager().max_size(), 50 + reserved.size());
+		for (const auto entity : reserved) {
+			EXPECT_EQ(archetype_of(entity), EMPTY_ARCHETYPE_ID);
+		}
+
+		//structural changes flush on their own
+		const auto late = world.reserve_entity();
+		world.add_components(late, WorldVelocity{1.0f, 0.0f});
+		ASSERT_NE(get<WorldVelocity>(late), nullptr);
+		EXPECT_EQ(get<WorldVelocity>(late)->x, 1.0f);
+	}
+
+	TEST_F(WorldTest, CloneIntoCopiesTheWholeWorld) {
+		std::vector<Entity> entities;
+		for (int i = 0; i < 30; ++i) {
+			entities.push_back(i % 2 == 0
+				? world.create_entity(WorldPosition{static_cast<float>(i), 0.0f}, Tracked{i})
+				: world.create_entity(WorldPosition{static_cast<float>(i), 0.0f}, WorldHealth{i}));
+		}
+		world.destroy_entity(entities[3]);
+
+		World clone;
+		world.clone_into(clone);
+		EXPECT_EQ(Tracked::alive, 30);
+		EXPECT_EQ(clone.entity_manager().size(), world.entity_manager().size());
+		EXPECT_EQ(clone.change_tick(), world.change_tick());
+
+		//the clone is independent from the source
+		get<WorldPosition>(entities[0])->x = 100.0f;
+		world.destroy_entity(entities[1]);
+		const auto& clone_table = clone.storage()[clone.entity_manager().get_location(entities[0])->table_id];
+		const auto* const clone_positions = clone_table[clone.component_manager().component_id<WorldPosition>()].data().data();
+		EXPECT_TRUE(clone.entity_manager().is_valid(entities[1]));
+		EXPECT_FALSE(clone.entity_manager().is_valid(entities[3]));
+
+		for (size_t i = 0; i < entities.size(); ++i) {
+			if (i == 3) {
+				continue;
+			}
+			const auto location = clone.entity_manager().get_location(entities[i]);
+			ASSERT_TRUE(location.has_value());
+			const auto& table = clone.storage()[location->table_id];
+			const auto& position = *table[clone.component_manager().component_id<WorldPosition>()].data().get<WorldPosition>(location->table_row.to_index());
+			EXPECT_FLOAT_EQ(position.x, static_cast<float>(i));
+			if (i % 2 == 1) {
+				const auto health = clone.component_manager().component_id<WorldHealth>();
+				EXPECT_EQ(clone.storage()[health].get<WorldHealth>(entities[i])->get().value, static_cast<int>(i));
+			}
+		}
+
+		//cloning again rolls the clone back without reallocating its columns
+		world.clone_into(clone);
+		EXPECT_FALSE(clone.entity_manager().is_valid(entities[1]));
+		EXPECT_EQ(clone_table[clone.component_manager().component_id<WorldPosition>()].data().data(), clone_positions);
+		EXPECT_EQ(Tracked::alive, 30);
+	}
+
+	TEST_F(WorldTest, CloneIntoTellsApartComponentsPastTheMask) {
+		World clone;
+		[&]<size_t ... Is>(std::index_sequence<Is...>) {
+			world.register_components<WorldWide<Is>...>();
+			clone.register_components<WorldWide<Is>...>();
+		}(std::make_index_sequence<300>{});
+		ASSERT_FALSE(ComponentMask::fits(world.component_manager().component_id<WorldWide<298>>()));
+
+		//both archetypes get the same id, same table and same mask
+		const auto entity = world.create_entity(WorldWide<298>{1});
+		clone.create_entity(WorldWide<299>{2});
+		world.clone_into(clone);
+
+		EXPECT_TRUE(clone.has_component(entity, clone.component_manager().component_id<WorldWide<298>>()));
+		EXPECT_FALSE(clone.has_component(entity, clone.component_manager().component_id<WorldWide<299>>()));
+	}
+
+	TEST(WorldArena, StorageIsAllocatedFromArena) {
+		static constexpr int COUNT = 1000;
+		utils::MemoryArena arena;
+
+		const auto fill = [&](World& world) {
+			for (int i = 0; i < COUNT; ++i) {
+				world.create_entity(WorldPosition{static_cast<float>(i), 0.0f}, WorldHealth{i});
+			}
+			const auto health = world.component_manager().component_id<WorldHealth>();
+			EXPECT_EQ(world.storage().sparse_sets[health].size(), COUNT);
+		};
+
+		size_t reserved = 0;
+		{
+			World world{arena.allocator()};
+			fill(world);
+			EXPECT_GE(arena.allocated_bytes(), COUNT * (sizeof(WorldPosition) + sizeof(WorldHealth)));
+			reserved = arena.reserved_bytes();
+		}
+		EXPECT_EQ(arena.allocated_bytes(), 0);
+
+		//a second world of the same shape is served from the blocks the first one freed
+		{
+			World world{arena.allocator()};
+			fill(world);
+			EXPECT_EQ(arena.reserved_bytes(), reserved);
+		}
+		EXPECT_EQ(arena.allocated_bytes(), 0);
+	}
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+/*
+	Allocator is a non owning handle to a memory resource, copied into every container allocating through it.
+
+	The default handle calls the global aligned operator new and delete.
+	Any type with allocate(bytes, align) and deallocate(ptr, bytes, align) can be wrapped with Allocator::of,
+	it has to outlive every container using the handle.
+	Deallocation gets the size and alignment of the allocation back, so resources don't have to store them.
+ */
+namespace glaze::utils {
+	struct Allocator {
+		using AllocateFn = void*(*)(void* resource, size_t bytes, size_t align) noexcept;
+		using DeallocateFn = void(*)(void* resource, void* ptr, size_t bytes, size_t align) noexcept;
+
+		constexpr Allocator() noexcept = default;
+
+		template<typename R>
+		[[nodiscard]] static Allocator of(R& resource) noexcept {
+			return Allocator{
+				std::addressof(resource),
+				[](void* const r, const size_t bytes, const size_t align) noexcept -> void* {
+					return static_cast<R*>(r)->allocate(bytes, align);
+				},
+				[](void* const r, void* const ptr, const size_t bytes, const size_t align) noexcept {
+					static_cast<R*>(r)->deallocate(ptr, bytes, align);
+				}
+			};
+		}
+
+		//null if the resource is out of memory
+		[[nodiscard]] void* allocate(const size_t bytes, const size_t align) const noexcept {
+			return m_allocate(m_resource, bytes, align);
+		}
+
+		void deallocate(void* const ptr, const size_t bytes, const size_t align) const noexcept {
+			m_deallocate(m_resource, ptr, bytes, align);
+		}
+
+		[[nodiscard]] constexpr bool operator==(const Allocator&) const noexcept = default;
+
+	private:
+		constexpr Allocator(void* const resource, const AllocateFn allocate, const DeallocateFn deallocate) noexcept
+			: m_resource(resource), m_allocate(allocate), m_deallocate(deallocate) {
+		}
+
+		static void* global_allocate(void*, const size_t bytes, const size_t align) noexcept {
+			return operator new(bytes, static_cast<std::align_val_t>(align), std::nothrow);
+		}
+
+		static void global_deallocate(void*, void* const ptr, size_t, const size_t align) noexcept {
+			operator delete(ptr, static_cast<std::align_val_t>(align));
+		}
+
+		void* m_resource = nullptr;
+		AllocateFn m_allocate = &global_allocate;
+		DeallocateFn m_deallocate = &global_deallocate;
+	};
+
+	//adapts an Allocator to the standard allocator requirements, so std::vector can allocate through it
+	template<typename T>
+	struct StdAllocator {
+		using value_type = T;
+		using propagate_on_container_move_assignment = std::true_type;
+		using propagate_on_container_swap = std::true_type;
+
+		constexpr StdAllocator() noexcept = default;
+		constexpr StdAllocator(const Allocator allocator) noexcept : allocator(allocator) {}
+
+		template<typename U>
+		constexpr StdAllocator(const StdAllocator<U>& other) noexcept : allocator(other.allocator) {}
+
+		[[nodiscard]] T* allocate(const size_t n) const {
+			void* const ptr = allocator.allocate(n * sizeof(T), alignof(T));
+			if (!ptr) [[unlikely]] {
+				throw std::bad_alloc();
+			}
+			return static_cast<T*>(ptr);
+		}
+
+		void deallocate(T* const ptr, const size_t n) const noexcept {
+			allocator.deallocate(ptr, n * sizeof(T), alignof(T));
+		}
+
+		template<typename U>
+		[[nodiscard]] constexpr bool operator==(const StdAllocator<U>& other) const noexcept { return allocator == other.allocator; }
+
+		Allocator allocator;
+	};
+}
\ No newline at end of file
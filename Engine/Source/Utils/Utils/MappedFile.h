@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/*
+	Read only view of a whole file.
+
+	The file is mapped into memory where mmap is available, so pages are only read when they're touched
+	and the OS can drop them again under memory pressure. Elsewhere it's read into a buffer.
+ */
+namespace glaze::utils {
+	struct MappedFile {
+		MappedFile() = default;
+
+		//an empty view if the file can't be opened
+		explicit MappedFile(const std::filesystem::path& path) {
+#if defined(__linux__) || defined(__APPLE__)
+			const int fd = ::open(path.c_str(), O_RDONLY);
+			if (fd < 0) {
+				return;
+			}
+
+			struct stat info{};
+			if (::fstat(fd, &info) == 0 && info.st_size > 0) {
+				const auto size = static_cast<size_t>(info.st_size);
+				void* const data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+				if (data != MAP_FAILED) {
+					::madvise(data, size, MADV_SEQUENTIAL);
+					m_data = static_cast<const std::byte*>(data);
+					m_size = size;
+				}
+			}
+			::close(fd);
+#else
+			std::ifstream file(path, std::ios::binary | std::ios::ate);
+			if (!file) {
+				return;
+			}
+			m_buffer.resize(static_cast<size_t>(file.tellg()));
+			file.seekg(0);
+			if (!file.read(reinterpret_cast<char*>(m_buffer.data()), static_cast<std::streamsize>(m_buffer.size()))) {
+				m_buffer.clear();
+			}
+			m_data = m_buffer.data();
+			m_size = m_buffer.size();
+#endif
+		}
+
+		~MappedFile() { unmap(); }
+
+		MappedFile(const MappedFile& other) = delete;
+		MappedFile& operator=(const MappedFile& other) = delete;
+
+		MappedFile(MappedFile&& other) noexcept
+			: m_data(std::exchange(other.m_data, nullptr)),
+			  m_size(std::exchange(other.m_size, 0)),
+			  m_buffer(std::move(other.m_buffer)) {
+		}
+
+		MappedFile& operator=(MappedFile&& other) noexcept {
+			if (this != &other) {
+				unmap();
+				m_data = std::exchange(other.m_data, nullptr);
+				m_size = std::exchange(other.m_size, 0);
+				m_buffer = std::move(other.m_buffer);
+			}
+			return *this;
+		}
+
+		[[nodiscard]] std::span<const std::byte> bytes() const noexcept { return { m_data, m_size }; }
+		[[nodiscard]] size_t size() const noexcept { return m_size; }
+		[[nodiscard]] bool empty() const noexcept { return m_size == 0; }
+
+	private:
+		void unmap() noexcept {
+#if defined(__linux__) || defined(__APPLE__)
+			if (m_data) {
+				::munmap(const_cast<std::byte*>(m_data), m_size);
+			}
+#endif
+			m_data = nullptr;
+			m_size = 0;
+			m_buffer.clear();
+		}
+
+		const std::byte* m_data = nullptr;
+		size_t m_size = 0;
+		//contents of the file where it can't be mapped
+		std::vector<std::byte> m_buffer;
+	};
+}
\ No newline at end of file
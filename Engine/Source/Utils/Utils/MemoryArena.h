@@ -0,0 +1,213 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <sys/mman.h>
+#endif
+
+#include "Allocator.h"
+
+/*
+	Pool of power of two size classes carved out of large regions.
+
+	A freed block goes to the free list of its class and the next allocation of that class reuses it,
+	so storage growing and shrinking during a long run stays inside the same few regions instead of fragmenting the heap.
+	Regions are mapped directly from the OS and, on Linux, advised to be backed by transparent huge pages.
+	Allocations bigger than the largest class get a mapping of their own, which is unmapped again when they're freed.
+
+	An arena isn't thread safe, it's meant to back the storage of one world whose structural changes happen on one thread.
+ */
+namespace glaze::utils {
+	struct MemoryArena {
+		struct Options {
+			//has to be at least MAX_CLASS_BYTES, multiples of HUGE_PAGE_BYTES can be backed by huge pages
+			size_t region_bytes = 4 * 1024 * 1024;
+			bool huge_pages = true;
+		};
+
+		static constexpr size_t MIN_CLASS_BYTES = 64;
+		static constexpr size_t MAX_CLASS_BYTES = 1024 * 1024;
+		//blocks of a class are aligned to their size up to a page, bigger alignments go through the global allocator
+		static constexpr size_t MAX_CLASS_ALIGN = 4096;
+		static constexpr size_t HUGE_PAGE_BYTES = 2 * 1024 * 1024;
+		static constexpr size_t CLASS_COUNT = std::countr_zero(MAX_CLASS_BYTES) - std::countr_zero(MIN_CLASS_BYTES) + 1;
+
+		MemoryArena() : MemoryArena(Options{}) {}
+
+		explicit MemoryArena(const Options& options) noexcept
+			: m_options(options) {
+			assert(m_options.region_bytes >= MAX_CLASS_BYTES && "Regions have to fit the largest class");
+		}
+
+		~MemoryArena() {
+			for (void* const region : m_regions) {
+				unmap(region, m_options.region_bytes);
+			}
+		}
+
+		MemoryArena(const MemoryArena& other) = delete;
+		MemoryArena& operator=(const MemoryArena& other) = delete;
+
+		//allocators handed out point at the arena
+		MemoryArena(MemoryArena&& other) = delete;
+		MemoryArena& operator=(MemoryArena&& other) = delete;
+
+		[[nodiscard]] void* allocate(const size_t bytes, const size_t align) noexcept {
+			if (align > MAX_CLASS_ALIGN) {
+				m_allocated_bytes += bytes;
+				return operator new(bytes, static_cast<std::align_val_t>(align), std::nothrow);
+			}
+
+			const size_t size = class_size(bytes, align);
+			if (size > MAX_CLASS_BYTES) {
+				const size_t mapped = map_size(bytes);
+				void* const ptr = map(mapped, m_options.huge_pages && mapped >= HUGE_PAGE_BYTES);
+				if (ptr) {
+					m_allocated_bytes += mapped;
+					m_large_bytes += mapped;
+				}
+				return ptr;
+			}
+
+			auto& free_list = m_free_lists[class_index(size)];
+			if (free_list) {
+				FreeBlock* const block = free_list;
+				free_list = block->next;
+				m_allocated_bytes += size;
+				return block;
+			}
+
+			void* const ptr = carve(size);
+			if (ptr) {
+				m_allocated_bytes += size;
+			}
+			return ptr;
+		}
+
+		void deallocate(void* const ptr, const size_t bytes, const size_t align) noexcept {
+			if (!ptr) {
+				return;
+			}
+
+			if (align > MAX_CLASS_ALIGN) {
+				m_allocated_bytes -= bytes;
+				operator delete(ptr, static_cast<std::align_val_t>(align));
+				return;
+			}
+
+			const size_t size = class_size(bytes, align);
+			if (size > MAX_CLASS_BYTES) {
+				const size_t mapped = map_size(bytes);
+				unmap(ptr, mapped);
+				m_allocated_bytes -= mapped;
+				m_large_bytes -= mapped;
+				return;
+			}
+
+			auto& free_list = m_free_lists[class_index(size)];
+			free_list = ::new (ptr) FreeBlock{ free_list };
+			m_allocated_bytes -= size;
+		}
+
+		[[nodiscard]] Allocator allocator() noexcept { return Allocator::of(*this); }
+
+		//bytes handed out and not freed yet, rounded up to their class
+		[[nodiscard]] size_t allocated_bytes() const noexcept { return m_allocated_bytes; }
+		//bytes taken from the OS for regions and large allocations
+		[[nodiscard]] size_t reserved_bytes() const noexcept { return m_regions.size() * m_options.region_bytes + m_large_bytes; }
+		[[nodiscard]] size_t region_count() const noexcept { return m_regions.size(); }
+		[[nodiscard]] const Options& options() const noexcept { return m_options; }
+
+	private:
+		struct FreeBlock {
+			FreeBlock* next;
+		};
+
+		[[nodiscard]] static constexpr size_t class_size(const size_t bytes, const size_t align) noexcept {
+			return std::bit_ceil(std::max({bytes, align, MIN_CLASS_BYTES}));
+		}
+
+		[[nodiscard]] static constexpr size_t class_index(const size_t size) noexcept {
+			return static_cast<size_t>(std::countr_zero(size) - std::countr_zero(MIN_CLASS_BYTES));
+		}
+
+		[[nodiscard]] static constexpr size_t map_size(const size_t bytes) noexcept {
+			return (bytes + MAX_CLASS_ALIGN - 1) & ~(MAX_CLASS_ALIGN - 1);
+		}
+
+		//bumps the cursor of the current region, the unused tail of a full region is left behind
+		[[nodiscard]] void* carve(const size_t size) noexcept {
+			const size_t align = std::min(size, MAX_CLASS_ALIGN);
+			auto cursor = (m_cursor + align - 1) & ~(align - 1);
+
+			if (m_regions.empty() || cursor + size > m_end) {
+				void* const region = map(m_options.region_bytes, m_options.huge_pages && m_options.region_bytes % HUGE_PAGE_BYTES == 0);
+				if (!region) {
+					return nullptr;
+				}
+				m_regions.push_back(region);
+				cursor = reinterpret_cast<uintptr_t>(region);
+				m_end = cursor + m_options.region_bytes;
+			}
+
+			m_cursor = cursor + size;
+			return reinterpret_cast<void*>(cursor);
+		}
+
+		//page aligned and zeroed, huge page mappings are also aligned to HUGE_PAGE_BYTES
+		[[nodiscard]] static void* map(const size_t bytes, const bool huge_pages) noexcept {
+#if defined(__linux__) || defined(__APPLE__)
+			const size_t padding = huge_pages ? HUGE_PAGE_BYTES : 0;
+			void* const mapped = mmap(nullptr, bytes + padding, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			if (mapped == MAP_FAILED) {
+				return nullptr;
+			}
+			if (!huge_pages) {
+				return mapped;
+			}
+
+			//trims the padding around the aligned range
+			const auto begin = reinterpret_cast<uintptr_t>(mapped);
+			const auto aligned = (begin + HUGE_PAGE_BYTES - 1) & ~(HUGE_PAGE_BYTES - 1);
+			if (aligned != begin) {
+				munmap(mapped, aligned - begin);
+			}
+			if (const auto tail = begin + bytes + padding - (aligned + bytes); tail != 0) {
+				munmap(reinterpret_cast<void*>(aligned + bytes), tail);
+			}
+#if defined(__linux__)
+			madvise(reinterpret_cast<void*>(aligned), bytes, MADV_HUGEPAGE);
+#endif
+			return reinterpret_cast<void*>(aligned);
+#else
+			(void)huge_pages;
+			return operator new(bytes, static_cast<std::align_val_t>(MAX_CLASS_ALIGN), std::nothrow);
+#endif
+		}
+
+		static void unmap(void* const ptr, const size_t bytes) noexcept {
+#if defined(__linux__) || defined(__APPLE__)
+			munmap(ptr, bytes);
+#else
+			(void)bytes;
+			operator delete(ptr, static_cast<std::align_val_t>(MAX_CLASS_ALIGN));
+#endif
+		}
+
+		Options m_options;
+		std::vector<void*> m_regions;
+		uintptr_t m_cursor = 0;
+		uintptr_t m_end = 0;
+		std::array<FreeBlock*, CLASS_COUNT> m_free_lists{};
+		size_t m_allocated_bytes = 0;
+		size_t m_large_bytes = 0;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,18 @@
+#pragma once
+
+#if defined(_MSC_VER) && !defined(__clang__) && (defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h>
+#endif
+
+namespace glaze::utils {
+	//cache hint only, the address is never dereferenced so it doesn't have to be valid
+	inline void prefetch(const void* const address) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+		__builtin_prefetch(address);
+#elif defined(_M_X64) || defined(_M_IX86)
+		_mm_prefetch(static_cast<const char*>(address), _MM_HINT_T0);
+#else
+		(void)address;
+#endif
+	}
+}
@@ -1,12 +1,14 @@
 #pragma once
 
+#include <span>
+#include <utility>
 #include <vector>
 
 #include "Panic.h"
 
 namespace glaze::utils {
-	template<typename T>
-	constexpr T swap_remove(std::vector<T>& vec, size_t index) noexcept {
+	template<typename T, typename A>
+	constexpr T swap_remove(std::vector<T, A>& vec, size_t index) noexcept {
 		static_assert(std::is_nothrow_move_constructible_v<T>);
 		static_assert(std::is_nothrow_move_assignable_v<T>);
 		if (vec.size() <= index) {
@@ -17,4 +19,41 @@ namespace glaze::utils {
 		vec.pop_back();
 		return val;
 	}
+
+	struct SwapRemoveMove {
+		size_t from;
+		size_t to;
+	};
+
+	//moves that fill the holes of the removed indices with the last surviving elements, indices have to be sorted and unique
+	//ends up like swap removing them one by one from the highest index down, but every element is moved at most once
+	[[nodiscard]] inline std::vector<SwapRemoveMove> swap_remove_moves(const std::span<const size_t> sorted_indices, const size_t size) {
+		std::vector<SwapRemoveMove> moves;
+		size_t last = size;
+		size_t tail = sorted_indices.size();
+		for (size_t i = 0; i < sorted_indices.size(); ++i) {
+			//removed elements at the end leave no hole
+			while (tail > i && sorted_indices[tail - 1] == last - 1) {
+				--tail;
+				--last;
+			}
+			if (i >= tail) {
+				break;
+			}
+
+			--last;
+			moves.push_back({ last, sorted_indices[i] });
+		}
+		return moves;
+	}
+
+	//removes the sorted unique indices applying moves made by swap_remove_moves
+	template<typename T, typename A>
+	constexpr void swap_remove_many(std::vector<T, A>& vec, const std::span<const size_t> sorted_indices, const std::span<const SwapRemoveMove> moves) noexcept {
+		static_assert(std::is_nothrow_move_assignable_v<T>);
+		for (const auto [from, to] : moves) {
+			vec[to] = std::move(vec[from]);
+		}
+		vec.erase(vec.end() - static_cast<std::ptrdiff_t>(sorted_indices.size()), vec.end());
+	}
 }
\ No newline at end of file
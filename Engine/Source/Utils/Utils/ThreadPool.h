@@ -0,0 +1,231 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+/*
+	Fixed size pool of worker threads with one task deque per worker.
+
+	Workers pop from the back of their own deque and steal from the front of the other deques when it runs dry,
+	so uneven batches get rebalanced without a shared queue.
+	The thread calling parallel_for doesn't sleep, it helps executing batches until all of them are done.
+	Task graphs submit their tasks one by one as they become ready and wait with help_until.
+ */
+namespace glaze::utils {
+	struct ThreadPool {
+		struct Task {
+			using Fn = void(*)(void* context, size_t begin, size_t end) noexcept;
+
+			Fn fn = nullptr;
+			void* context = nullptr;
+			size_t begin = 0;
+			size_t end = 0;
+		};
+
+		explicit ThreadPool(const size_t worker_count = default_worker_count())
+			: m_queues(worker_count) {
+			m_workers.reserve(worker_count);
+			for (size_t i = 0; i < worker_count; ++i) {
+				m_workers.emplace_back([this, i] { worker_loop(i); });
+			}
+		}
+
+		~ThreadPool() {
+			{
+				std::scoped_lock lock(m_mutex);
+				m_stop = true;
+			}
+			m_wake.notify_all();
+
+			for (auto& worker : m_workers) {
+				worker.join();
+			}
+		}
+
+		ThreadPool(const ThreadPool& other) = delete;
+		ThreadPool& operator=(const ThreadPool& other) = delete;
+
+		ThreadPool(ThreadPool&& other) = delete;
+		ThreadPool& operator=(ThreadPool&& other) = delete;
+
+		//splits [0, count) into batches of at least min_batch_size and blocks until func(begin, end) returned for all of them
+		template<typename F>
+		void parallel_for(const size_t count, const size_t min_batch_size, F&& func) {
+			if (count == 0) {
+				return;
+			}
+
+			const size_t max_batches = concurrency() * 4;
+			const size_t batch_size = std::max({min_batch_size, size_t{1}, (count + max_batches - 1) / max_batches});
+			if (m_workers.empty() || batch_size >= count) {
+				func(size_t{0}, count);
+				return;
+			}
+
+			struct Context {
+				std::remove_reference_t<F>* func;
+				std::atomic<size_t> remaining;
+			};
+
+			Context context{ std::addressof(func), (count + batch_size - 1) / batch_size };
+			const Task::Fn fn = [](void* const ptr, const size_t begin, const size_t end) noexcept {
+				auto& ctx = *static_cast<Context*>(ptr);
+				(*ctx.func)(begin, end);
+				ctx.remaining.fetch_sub(1, std::memory_order_acq_rel);
+			};
+
+			push_batches(fn, &context, count, batch_size);
+			help_until([&] { return context.remaining.load(std::memory_order_acquire) == 0; });
+		}
+
+		//queues a single task, which may itself submit more tasks, needs at least one worker
+		void submit(const Task task) {
+			assert(!m_workers.empty() && "Submitting a task to a pool without workers would never run it");
+			m_queues[current_thread_index() % m_queues.size()].push_back(task);
+			publish(1);
+		}
+
+		//executes pending tasks on the calling thread until done() returns true
+		template<typename F>
+		void help_until(F&& done) {
+			while (!done()) {
+				if (!run_pending_task()) {
+					std::this_thread::yield();
+				}
+			}
+		}
+
+		//index of the calling thread in [0, concurrency()), the thread owning the pool gets the last one
+		[[nodiscard]] size_t current_thread_index() const noexcept {
+			return s_current_pool == this ? s_current_index : m_workers.size();
+		}
+
+		//workers plus the calling thread, which helps executing batches
+		[[nodiscard]] size_t concurrency() const noexcept { return m_workers.size() + 1; }
+		[[nodiscard]] size_t worker_count() const noexcept { return m_workers.size(); }
+
+		[[nodiscard]] static size_t default_worker_count() noexcept {
+			return std::max(1u, std::thread::hardware_concurrency()) - 1;
+		}
+
+	private:
+		struct Queue {
+			void push_back(const Task task) {
+				std::scoped_lock lock(m_mutex);
+				m_tasks.push_back(task);
+			}
+
+			[[nodiscard]] std::optional<Task> pop_back() noexcept {
+				std::scoped_lock lock(m_mutex);
+				if (m_tasks.empty()) {
+					return std::nullopt;
+				}
+				const Task task = m_tasks.back();
+				m_tasks.pop_back();
+				return task;
+			}
+
+			[[nodiscard]] std::optional<Task> steal_front() noexcept {
+				std::scoped_lock lock(m_mutex);
+				if (m_tasks.empty()) {
+					return std::nullopt;
+				}
+				const Task task = m_tasks.front();
+				m_tasks.pop_front();
+				return task;
+			}
+
+		private:
+			std::mutex m_mutex;
+			std::deque<Task> m_tasks;
+		};
+
+		void push_batches(const Task::Fn fn, void* const context, const size_t count, const size_t batch_size) {
+			//start with the own queue when called from a worker, so nested batches stay local
+			const size_t first_queue = current_thread_index() % m_queues.size();
+
+			ptrdiff_t pushed = 0;
+			for (size_t begin = 0, i = first_queue; begin < count; begin += batch_size, ++i) {
+				const size_t end = std::min(begin + batch_size, count);
+				m_queues[i % m_queues.size()].push_back(Task{ fn, context, begin, end });
+				++pushed;
+			}
+
+			publish(pushed);
+		}
+
+		//wakes the workers up for tasks pushed to the queues
+		void publish(const ptrdiff_t pushed) {
+			{
+				std::scoped_lock lock(m_mutex);
+				m_pending.fetch_add(pushed, std::memory_order_release);
+			}
+			m_wake.notify_all();
+		}
+
+		[[nodiscard]] std::optional<Task> pop_task(const size_t own_queue) noexcept {
+			const size_t queue_count = m_queues.size();
+			if (own_queue < queue_count) {
+				if (auto task = m_queues[own_queue].pop_back()) {
+					return task;
+				}
+			}
+
+			for (size_t i = 1; i <= queue_count; ++i) {
+				if (auto task = m_queues[(own_queue + i) % queue_count].steal_front()) {
+					return task;
+				}
+			}
+
+			return std::nullopt;
+		}
+
+		bool run_pending_task() noexcept {
+			const auto task = pop_task(current_thread_index());
+			if (!task) {
+				return false;
+			}
+
+			m_pending.fetch_sub(1, std::memory_order_acq_rel);
+			task->fn(task->context, task->begin, task->end);
+			return true;
+		}
+
+		void worker_loop(const size_t index) noexcept {
+			s_current_pool = this;
+			s_current_index = index;
+
+			while (true) {
+				if (run_pending_task()) {
+					continue;
+				}
+
+				std::unique_lock lock(m_mutex);
+				m_wake.wait(lock, [this] { return m_stop || m_pending.load(std::memory_order_acquire) > 0; });
+				if (m_stop) {
+					return;
+				}
+			}
+		}
+
+		static inline thread_local const ThreadPool* s_current_pool = nullptr;
+		static inline thread_local size_t s_current_index = 0;
+
+		std::vector<Queue> m_queues;
+		std::vector<std::thread> m_workers;
+
+		std::mutex m_mutex;
+		std::condition_variable m_wake;
+		//can briefly go negative when a worker pops a task before the push is published
+		std::atomic<ptrdiff_t> m_pending = 0;
+		bool m_stop = false;
+	};
+}
\ No newline at end of file
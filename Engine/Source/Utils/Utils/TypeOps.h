@@ -5,6 +5,11 @@
 #include <memory>
 
 namespace glaze::utils {
+	//objects that can change address by copying their bytes, the source is then treated as destroyed
+	//trivially copyable types are detected, others opt in with `static constexpr bool TRIVIALLY_RELOCATABLE = true;`
+	template<typename T>
+	concept TriviallyRelocatable = std::is_trivially_copyable_v<T> || requires { requires T::TRIVIALLY_RELOCATABLE; };
+
 	struct TypeOps {
 		using ConstructorFn = void(*)(void* obj);
 		using DestructorFn  = void(*)(void* obj) noexcept;
@@ -27,6 +32,9 @@ namespace glaze::utils {
 				"TypeOps requires nothrow move assignable types (move operator is noexcept).");
 
 			TypeOps ops{};
+			ops.trivially_relocatable = TriviallyRelocatable<U>;
+			ops.trivially_destructible = std::is_trivially_destructible_v<U>;
+			ops.trivially_copyable = std::is_trivially_copyable_v<U>;
 
 			if constexpr (std::is_default_constructible_v<U>) {
 				ops.construct = [](void* const obj) noexcept(std::is_nothrow_default_constructible_v<U>) {
@@ -73,5 +81,11 @@ namespace glaze::utils {
 
 		CopyCtorFn    copy_construct = nullptr;
 		CopyAssignFn  copy_assign    = nullptr;
+
+		//let containers memcpy elements and skip destructor calls instead of calling the functions above one by one
+		bool trivially_relocatable  = false;
+		bool trivially_destructible = false;
+		//copies and snapshots can be made of the bytes
+		bool trivially_copyable = false;
 	};
 }
\ No newline at end of file